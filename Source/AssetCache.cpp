@@ -0,0 +1,54 @@
+#include "AssetCache.h"
+
+AssetCache::AssetCache()
+{
+    images[static_cast<size_t>(ImageId::background)] =
+        juce::ImageFileFormat::loadFrom(BinaryData::BACKGROUND_png, BinaryData::BACKGROUND_pngSize);
+    images[static_cast<size_t>(ImageId::buttonOn)] =
+        juce::ImageFileFormat::loadFrom(BinaryData::BUTTONON_png, BinaryData::BUTTONON_pngSize);
+    images[static_cast<size_t>(ImageId::buttonOff)] =
+        juce::ImageFileFormat::loadFrom(BinaryData::BUTTONOFF_png, BinaryData::BUTTONOFF_pngSize);
+
+    boldTypeface = juce::Typeface::createSystemTypefaceFor(BinaryData::bold_ttf, BinaryData::bold_ttfSize);
+
+    for (const auto& image : images)
+        jassert(image.isValid());
+}
+
+const juce::Image& AssetCache::getImage(ImageId id) const
+{
+    return images[static_cast<size_t>(id)];
+}
+
+juce::Image AssetCache::getScaledImage(ImageId id, int width, int height)
+{
+    const auto& source = getImage(id);
+
+    if (!source.isValid() || width <= 0 || height <= 0)
+        return {};
+
+    if (source.getWidth() == width && source.getHeight() == height)
+        return source;
+
+    const juce::ScopedLock sl(lock);
+
+    for (auto it = scaledImages.begin(); it != scaledImages.end(); ++it)
+    {
+        if (it->id == id && it->width == width && it->height == height)
+        {
+            // move to the back so it survives eviction
+            auto found = std::move(*it);
+            scaledImages.erase(it);
+            scaledImages.push_back(std::move(found));
+            return scaledImages.back().image;
+        }
+    }
+
+    if (scaledImages.size() >= maxScaledImages)
+        scaledImages.erase(scaledImages.begin());
+
+    scaledImages.push_back({ id, width, height,
+        source.rescaled(width, height, juce::Graphics::highResamplingQuality) });
+
+    return scaledImages.back().image;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+// process-wide cache for the embedded PNGs and font, shared by every open editor through
+// juce::SharedResourcePointer<AssetCache>. each asset is decoded once; scaled variants are
+// kept per physical size so painting is a plain 1:1 blit.
+class AssetCache
+{
+public:
+    enum class ImageId
+    {
+        background,
+        buttonOn,
+        buttonOff,
+        numImages
+    };
+
+    AssetCache();
+
+    const juce::Image& getImage(ImageId id) const;
+
+    // pre-scaled copy of an image at a size in physical pixels
+    juce::Image getScaledImage(ImageId id, int width, int height);
+
+    juce::Typeface::Ptr getBoldTypeface() const { return boldTypeface; }
+
+private:
+    struct ScaledImage
+    {
+        ImageId id;
+        int width = 0;
+        int height = 0;
+        juce::Image image;
+    };
+
+    std::array<juce::Image, static_cast<size_t>(ImageId::numImages)> images;
+    std::vector<ScaledImage> scaledImages;     // most recently used at the back
+    juce::Typeface::Ptr boldTypeface;
+
+    juce::CriticalSection lock;
+
+    // a few sizes per image covers several editors on mixed-DPI screens
+    static constexpr size_t maxScaledImages = 12;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AssetCache)
+};
@@ -0,0 +1,27 @@
+#include "BackgroundLayer.h"
+
+BackgroundLayer::BackgroundLayer()
+{
+    setOpaque(true);
+    setBufferedToImage(true);
+    setInterceptsMouseClicks(false, false);
+}
+
+void BackgroundLayer::paint(juce::Graphics& g)
+{
+    // scale once to the physical size and blit it 1:1
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto backgroundImage = assets->getScaledImage(AssetCache::ImageId::background,
+        juce::roundToInt(getWidth() * scale), juce::roundToInt(getHeight() * scale));
+
+    // check if the image loaded
+    if (backgroundImage.isValid())
+    {
+        g.drawImage(backgroundImage, getLocalBounds().toFloat());
+    }
+    else
+    {
+        // fallback to a solid if  image fails 
+        g.fillAll(juce::Colours::black);
+    }
+}
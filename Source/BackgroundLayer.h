@@ -0,0 +1,19 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "AssetCache.h"
+
+// opaque editor background. it's buffered to an image, so the PNG is only
+// drawn again when the editor is resized or moved to a different scale.
+class BackgroundLayer : public juce::Component
+{
+public:
+    BackgroundLayer();
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    juce::SharedResourcePointer<AssetCache> assets;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BackgroundLayer)
+};
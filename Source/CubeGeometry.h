@@ -0,0 +1,30 @@
+#pragma once
+
+// wireframe cube shared by the GL and software renderers
+namespace CubeGeometry
+{
+    inline constexpr float vertices[] = {
+        // Positions
+        -1.0f, -1.0f, -1.0f, // 0
+         1.0f, -1.0f, -1.0f, // 1
+         1.0f,  1.0f, -1.0f, // 2
+        -1.0f,  1.0f, -1.0f, // 3
+        -1.0f, -1.0f,  1.0f, // 4
+         1.0f, -1.0f,  1.0f, // 5
+         1.0f,  1.0f,  1.0f, // 6
+        -1.0f,  1.0f,  1.0f  // 7
+    };
+
+    // index pairs for the cube lines (wireframe)
+    inline constexpr unsigned int indices[] = {
+        // front face
+        0, 1, 1, 2, 2, 3, 3, 0,
+        // back face
+        4, 5, 5, 6, 6, 7, 7, 4,
+        // edges between front and back faces
+        0, 4, 1, 5, 2, 6, 3, 7
+    };
+
+    inline constexpr int numVertices = sizeof(vertices) / (3 * sizeof(float));
+    inline constexpr int numEdges = sizeof(indices) / (2 * sizeof(unsigned int));
+}
@@ -0,0 +1,202 @@
+#include "CubeSoftwareRenderer.h"
+#include "CubeGeometry.h"
+
+void CubeSoftwareRenderer::render(juce::Graphics& g, juce::Rectangle<int> bounds, float pixelScale,
+    const juce::Matrix3D<float>& projectionMatrix, const juce::Matrix3D<float>& viewMatrix,
+    const std::array<Cube, 2>& cubes, float damp)
+{
+    const int width = juce::roundToInt(static_cast<float>(bounds.getWidth()) * pixelScale);
+    const int height = juce::roundToInt(static_cast<float>(bounds.getHeight()) * pixelScale);
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    // images live at physical resolution so the blur matches the GL path on HiDPI screens
+    if (sceneImage.getWidth() != width || sceneImage.getHeight() != height)
+    {
+        sceneImage = juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+        blurredImage = juce::Image(juce::Image::RGB, width, height, true, juce::SoftwareImageType());
+        hasCachedFrame = false;
+    }
+
+    // project both cubes
+    std::array<EdgeList, 2> newEdges;
+    std::array<juce::Colour, 2> newColours;
+    juce::Rectangle<int> newEdgeBounds;
+
+    for (size_t i = 0; i < cubes.size(); ++i)
+    {
+        const float s = cubes[i].scale;
+        juce::Matrix3D<float> scalingMatrix(
+            s, 0.0f, 0.0f, 0.0f,
+            0.0f, s, 0.0f, 0.0f,
+            0.0f, 0.0f, s, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f
+        );
+
+        projectEdges(newEdges[i], projectionMatrix * viewMatrix * scalingMatrix);
+        newColours[i] = cubes[i].colour.withAlpha(cubes[i].alpha);
+        newEdgeBounds = newEdgeBounds.getUnion(getEdgeBounds(newEdges[i]));
+    }
+
+    const bool dampChanged = damp != lastDamp;
+
+    // nothing moved since the last frame, reuse the blurred image as is
+    if (hasCachedFrame && !dampChanged && newEdges == projectedEdges && newColours == lastColours)
+    {
+        g.drawImage(blurredImage, bounds.toFloat());
+        return;
+    }
+
+    // redraw only where the old and new edges are, everything else in the scene is empty
+    const int linePadding = static_cast<int>(std::ceil(lineWidth)) + 1;
+    auto sceneRegion = hasCachedFrame ? newEdgeBounds.getUnion(lastEdgeBounds).expanded(linePadding)
+                                      : sceneImage.getBounds();
+    sceneRegion = sceneRegion.getIntersection(sceneImage.getBounds());
+
+    if (!sceneRegion.isEmpty())
+    {
+        sceneImage.clear(sceneRegion);
+
+        juce::Graphics sceneGraphics(sceneImage);
+        sceneGraphics.reduceClipRegion(sceneRegion);
+
+        // red cube first, then the translucent white one, same order as the GL pass
+        for (size_t i = 0; i < newEdges.size(); ++i)
+        {
+            sceneGraphics.setColour(newColours[i]);
+            for (const auto& edge : newEdges[i])
+                sceneGraphics.drawLine(edge, lineWidth);
+        }
+    }
+
+    // the blur spreads horizontally, so widen the dirty region by the kernel reach
+    const float tapSpacing = (1.0f + damp * 2.0f) / 300.0f * static_cast<float>(width);
+    const int blurReach = static_cast<int>(std::ceil(4.0f * tapSpacing)) + 1;
+    auto blurArea = (hasCachedFrame && !dampChanged) ? sceneRegion.expanded(blurReach, 0)
+                                                     : blurredImage.getBounds();
+    blurArea = blurArea.getIntersection(blurredImage.getBounds());
+
+    if (!blurArea.isEmpty())
+        blurRegion(blurArea, tapSpacing);
+
+    projectedEdges = newEdges;
+    lastColours = newColours;
+    lastEdgeBounds = newEdgeBounds;
+    lastDamp = damp;
+    hasCachedFrame = true;
+
+    g.drawImage(blurredImage, bounds.toFloat());
+}
+
+void CubeSoftwareRenderer::reset()
+{
+    sceneImage = {};
+    blurredImage = {};
+    hasCachedFrame = false;
+    lastDamp = -1.0f;
+}
+
+void CubeSoftwareRenderer::projectEdges(EdgeList& edges, const juce::Matrix3D<float>& mvp) const
+{
+    const auto width = static_cast<float>(sceneImage.getWidth());
+    const auto height = static_cast<float>(sceneImage.getHeight());
+    const float* m = mvp.mat;
+
+    // column-major, same layout the shader receives
+    std::array<juce::Point<float>, CubeGeometry::numVertices> projected;
+
+    for (int v = 0; v < CubeGeometry::numVertices; ++v)
+    {
+        const float x = CubeGeometry::vertices[v * 3];
+        const float y = CubeGeometry::vertices[v * 3 + 1];
+        const float z = CubeGeometry::vertices[v * 3 + 2];
+
+        const float clipX = m[0] * x + m[4] * y + m[8] * z + m[12];
+        const float clipY = m[1] * x + m[5] * y + m[9] * z + m[13];
+        const float clipW = m[3] * x + m[7] * y + m[11] * z + m[15];
+
+        // NDC to pixels, y flipped because GL's origin is bottom-left
+        projected[static_cast<size_t>(v)] = { (clipX / clipW * 0.5f + 0.5f) * width,
+                                              (0.5f - clipY / clipW * 0.5f) * height };
+    }
+
+    for (int e = 0; e < CubeGeometry::numEdges; ++e)
+    {
+        edges[static_cast<size_t>(e)] = { projected[CubeGeometry::indices[e * 2]],
+                                          projected[CubeGeometry::indices[e * 2 + 1]] };
+    }
+}
+
+void CubeSoftwareRenderer::blurRegion(juce::Rectangle<int> region, float tapSpacing)
+{
+    // same 9-tap kernel as the GL blur shader
+    static constexpr float kernel[9] = { 0.05f, 0.09f, 0.12f, 0.15f, 0.18f, 0.15f, 0.12f, 0.09f, 0.05f };
+
+    // the tap spacing is constant across the image, so the integer offset and the
+    // interpolation fraction of each tap only need working out once per blur
+    int tapOffsets[9];
+    float tapWeights0[9];
+    float tapWeights1[9];
+
+    for (int i = 0; i < 9; ++i)
+    {
+        const float offset = static_cast<float>(i - 4) * tapSpacing;
+        tapOffsets[i] = static_cast<int>(std::floor(offset));
+        const float fraction = offset - static_cast<float>(tapOffsets[i]);
+        tapWeights0[i] = kernel[i] * (1.0f - fraction);
+        tapWeights1[i] = kernel[i] * fraction;
+    }
+
+    const juce::Image::BitmapData src(sceneImage, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData dst(blurredImage, juce::Image::BitmapData::writeOnly);
+
+    const int lastX = src.width - 1;
+
+    for (int y = region.getY(); y < region.getBottom(); ++y)
+    {
+        const auto* srcLine = src.getLinePointer(y);
+        auto* dstLine = dst.getLinePointer(y);
+
+        for (int x = region.getX(); x < region.getRight(); ++x)
+        {
+            float red = 0.0f, green = 0.0f, blue = 0.0f;
+
+            for (int i = 0; i < 9; ++i)
+            {
+                const int x0 = juce::jlimit(0, lastX, x + tapOffsets[i]);
+                const int x1 = juce::jmin(lastX, x0 + 1);
+                const auto* p0 = reinterpret_cast<const juce::PixelARGB*>(srcLine + x0 * src.pixelStride);
+                const auto* p1 = reinterpret_cast<const juce::PixelARGB*>(srcLine + x1 * src.pixelStride);
+
+                // premultiplied colour over black, which is what the GL scene FBO holds
+                red += tapWeights0[i] * p0->getRed() + tapWeights1[i] * p1->getRed();
+                green += tapWeights0[i] * p0->getGreen() + tapWeights1[i] * p1->getGreen();
+                blue += tapWeights0[i] * p0->getBlue() + tapWeights1[i] * p1->getBlue();
+            }
+
+            auto* out = reinterpret_cast<juce::PixelRGB*>(dstLine + x * dst.pixelStride);
+            out->setARGB(255,
+                static_cast<juce::uint8>(juce::jmin(255, juce::roundToInt(red))),
+                static_cast<juce::uint8>(juce::jmin(255, juce::roundToInt(green))),
+                static_cast<juce::uint8>(juce::jmin(255, juce::roundToInt(blue))));
+        }
+    }
+}
+
+juce::Rectangle<int> CubeSoftwareRenderer::getEdgeBounds(const EdgeList& edges)
+{
+    // min/max rather than Rectangle::getUnion, which drops the zero-width boxes of vertical edges
+    auto minX = edges[0].getStartX(), maxX = minX;
+    auto minY = edges[0].getStartY(), maxY = minY;
+
+    for (const auto& edge : edges)
+    {
+        minX = juce::jmin(minX, edge.getStartX(), edge.getEndX());
+        maxX = juce::jmax(maxX, edge.getStartX(), edge.getEndX());
+        minY = juce::jmin(minY, edge.getStartY(), edge.getEndY());
+        maxY = juce::jmax(maxY, edge.getStartY(), edge.getEndY());
+    }
+
+    return juce::Rectangle<float>::leftTopRightBottom(minX, minY, maxX, maxY).getSmallestIntegerContainer();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// CPU fallback for the MainComponent cube view, used when no GL 3.3 context is available.
+// mirrors the GL pipeline: the wireframes are drawn into a transparent scene image and a
+// horizontal 9-tap blur resolves it onto black. only the area swept by the edges is redrawn.
+class CubeSoftwareRenderer
+{
+public:
+    struct Cube
+    {
+        float scale = 1.0f;
+        juce::Colour colour;
+        float alpha = 1.0f;
+    };
+
+    void render(juce::Graphics& g, juce::Rectangle<int> bounds, float pixelScale,
+        const juce::Matrix3D<float>& projectionMatrix, const juce::Matrix3D<float>& viewMatrix,
+        const std::array<Cube, 2>& cubes, float damp);
+
+    void reset();
+
+private:
+    using EdgeList = std::array<juce::Line<float>, 12>;
+
+    void projectEdges(EdgeList& edges, const juce::Matrix3D<float>& mvp) const;
+    void blurRegion(juce::Rectangle<int> region, float tapSpacing);
+    static juce::Rectangle<int> getEdgeBounds(const EdgeList& edges);
+
+    juce::Image sceneImage;     // transparent, cubes only (matches the GL scene FBO)
+    juce::Image blurredImage;   // opaque, what actually gets painted
+
+    std::array<EdgeList, 2> projectedEdges;
+    std::array<juce::Colour, 2> lastColours;
+    juce::Rectangle<int> lastEdgeBounds;
+    float lastDamp = -1.0f;
+    bool hasCachedFrame = false;
+
+    static constexpr float lineWidth = 5.7f;    // same as glLineWidth in MainComponent::render
+};
@@ -2,11 +2,9 @@
 
 CustomLookAndFeel::CustomLookAndFeel()
 {
-    // load a custom typeface from binary data.
-    customTypeface = juce::Typeface::createSystemTypefaceFor(BinaryData::bold_ttf,
-        BinaryData::bold_ttfSize);
-    valueFont = juce::Typeface::createSystemTypefaceFor(BinaryData::bold_ttf,
-        BinaryData::bold_ttfSize);
+    // custom typeface, shared by every look-and-feel instance
+    customTypeface = assets->getBoldTypeface();
+    valueFont = juce::Font(customTypeface);
 }
 
 CustomLookAndFeel::~CustomLookAndFeel() {}
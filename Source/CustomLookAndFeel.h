@@ -1,6 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
 #include "MainComponent.h"
+#include "AssetCache.h"
 
 class CustomLookAndFeel : public juce::LookAndFeel_V4
 {
@@ -26,6 +27,8 @@ private:
 
     juce::Font getLabelFont(juce::Label& label) override;
 
+    juce::SharedResourcePointer<AssetCache> assets;   // shared typeface, decoded once per process
+
     juce::Typeface::Ptr customTypeface;
     juce::Font valueFont;
 
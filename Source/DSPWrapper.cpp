@@ -1,19 +1,385 @@
 #include "DSPWrapper.h"
 #include <JuceHeader.h>
 #include <cassert>
+#include <type_traits>
 #include "ParameterIDs.h"
+#include "SimdKernels.h"
 
-void DSPWrapper::prepare(double sampleRate, int numChannels)
+namespace
+{
+    template <typename DestType, typename SourceType>
+    void copySamples(DestType* dest, const SourceType* source, int numSamples)
+    {
+        if constexpr (std::is_same_v<DestType, SourceType>)
+        {
+            juce::FloatVectorOperations::copy(dest, source, numSamples);
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = static_cast<DestType>(source[i]);
+        }
+    }
+}
+
+void DSPWrapper::prepare(double sampleRate, int numChannels, int maxBlockSize, Precision newPrecision)
 {
     jassert(sampleRate > 0);
     jassert(numChannels > 0);
+    jassert(maxBlockSize > 0);
+
+    precision = newPrecision;
+    currentSampleRate.store(sampleRate, std::memory_order_relaxed);
+    tuningRampSamples = static_cast<int>(tuningRampSeconds * sampleRate);
+    ducker.prepare(sampleRate);
+    floatLimiter.prepare(sampleRate, numChannels);
+    doubleLimiter.prepare(sampleRate, numChannels);
+    governor.reset();
+    qualityFadeSamples = static_cast<int>(qualityFadeSeconds * sampleRate);
+
+    // start at the current values rather than ramping in from the defaults
+    for (auto* smoothed : { &sizeSmoothed, &widthSmoothed, &mixSmoothed, &decaySmoothed, &overlayMixSmoothed, &overlayOnSmoothed, &preDelaySmoothed })
+        smoothed->reset(sampleRate, smoothingSeconds);
+
+    sizeSmoothed.setCurrentAndTargetValue(lastSize);
+    widthSmoothed.setCurrentAndTargetValue(lastWidth);
+    mixSmoothed.setCurrentAndTargetValue(lastMix);
+    decaySmoothed.setCurrentAndTargetValue(lastDecay);
+    overlayMixSmoothed.setCurrentAndTargetValue(overlayMixSmoothed.getTargetValue());
+    overlayOnSmoothed.setCurrentAndTargetValue(overlayOn ? 1.0f : 0.0f);
+    preDelaySmoothed.setCurrentAndTargetValue(getPreDelayMs());
+
+    activeTuning = CustomReverb::makeTuning(lastSize, lastDecay, sampleRate, lastBands, isNetworkRateLimited());
+    tailSeconds.store(activeTuning.tailSeconds, std::memory_order_relaxed);
+
+    // the engine we don't need is freed, a precision change always comes through here
+    if (precision == Precision::single)
+    {
+        doubleEngine.reset();
+        floatEngine = std::make_unique<Engine<float>>();
+        prepareEngine(*floatEngine, sampleRate, numChannels, maxBlockSize);
+    }
+    else
+    {
+        floatEngine.reset();
+        doubleEngine = std::make_unique<Engine<double>>();
+        prepareEngine(*doubleEngine, sampleRate, numChannels, maxBlockSize);
+    }
+}
+
+template <typename StateType>
+void DSPWrapper::prepareEngine(Engine<StateType>& engine, double sampleRate, int numChannels, int maxBlockSize)
+{
+    engine.wetBuffer.setSize(numChannels, maxBlockSize);
+    engine.wetBuffer.clear();
+
+    engine.reverb.prepare(sampleRate, numChannels, maxBlockSize, isNetworkRateLimited());
+    engine.reverb.setTuning(activeTuning, 0);
+    engine.reverb.setPreDelay(static_cast<float>(preDelaySmoothed.getCurrentValue() * sampleRate / 1000.0));
+
+    for (auto* chain : { &engine.overlayChain, &engine.fadingOverlayChain })
+    {
+        chain->setActiveFilter(std::make_unique<VileFilterT<StateType>>());
+        chain->setDrive(10.0f); 
+    }
+
+    // polyphase IIR halfbands, they only add a few samples of phase delay
+    const auto makeOversampling = [numChannels, maxBlockSize](size_t numStages)
+    {
+        auto oversampling = std::make_unique<juce::dsp::Oversampling<StateType>>(
+            static_cast<size_t>(numChannels), numStages, juce::dsp::Oversampling<StateType>::filterHalfBandPolyphaseIIR, false);
+        oversampling->initProcessing(static_cast<size_t>(maxBlockSize));
+        return oversampling;
+    };
+
+    engine.oversampling2x = makeOversampling(1);
+    engine.oversampling4x = makeOversampling(2);
+    engine.overlayScratch.setSize(numChannels, maxBlockSize);
+    engine.overlayBypass.setSize(numChannels, maxBlockSize);
+
+    applyQuality(engine, getTargetQuality(), 0);
+}
+
+DSPWrapper::Quality DSPWrapper::getTargetQuality() const
+{
+    if (offlineRendering.load(std::memory_order_relaxed))
+        return Quality::render;
+
+    const int requested = static_cast<int>(requestedQuality.load(std::memory_order_relaxed));
+    const int stepsDown = governorEnabled.load(std::memory_order_relaxed) ? governor.getStepsDown() : 0;
+
+    return static_cast<Quality>(juce::jmax(static_cast<int>(Quality::eco), requested - stepsDown));
+}
+
+template <typename StateType>
+void DSPWrapper::applyQuality(Engine<StateType>& engine, Quality newQuality, int fadeSamples)
+{
+    engine.quality = newQuality;
+    activeQuality.store(newQuality, std::memory_order_relaxed);
+
+    const int numAllPasses = newQuality == Quality::render ? 6 : newQuality == Quality::high ? 4 : 2;
+    engine.reverb.setStages(newQuality == Quality::eco ? 4 : 8, numAllPasses, fadeSamples);
+
+    auto* oversampling = newQuality == Quality::render ? engine.oversampling4x.get()
+                       : newQuality == Quality::high   ? engine.oversampling2x.get()
+                                                       : nullptr;
+
+    if (oversampling != engine.overlayOversampling)
+    {
+        // the oversampling filters may hold audio from the last time they ran
+        if (oversampling != nullptr)
+            oversampling->reset();
+
+        engine.fadingOverlayOversampling = engine.overlayOversampling;
+        engine.overlayOversampling = oversampling;
+        engine.overlayFadeRemaining = fadeSamples;
+
+        // the overlay's state belongs to the rate it ran at, the new path starts from silence
+        std::swap(engine.overlayChain, engine.fadingOverlayChain);
+        engine.overlayChain.reset();
+    }
+}
+
+void DSPWrapper::updateGovernor(int numSamples, juce::int64 elapsedTicks)
+{
+    if (!governorEnabled.load(std::memory_order_relaxed) || offlineRendering.load(std::memory_order_relaxed))
+    {
+        governor.reset();
+        return;
+    }
+
+    governor.update(juce::Time::highResolutionTicksToSeconds(elapsedTicks), numSamples / getSampleRate());
+}
+
+template <typename StateType>
+void DSPWrapper::processOverlay(Engine<StateType>& engine, juce::AudioBuffer<StateType>& wet)
+{
+    const int numChannels = wet.getNumChannels();
+    const int numSamples = wet.getNumSamples();
+
+    // every channel in one call, the filters keep their state per channel
+    const auto runOverlay = [](OverlayFilterChainT<StateType>& chain, juce::dsp::AudioBlock<StateType> block)
+    {
+        std::array<StateType*, OverlayFilterT<StateType>::maxChannels> channels{};
+        const auto numBlockChannels = juce::jmin(block.getNumChannels(), channels.size());
+
+        for (size_t channel = 0; channel < numBlockChannels; ++channel)
+            channels[channel] = block.getChannelPointer(channel);
+
+        chain.processBlock(channels.data(), static_cast<int>(numBlockChannels), static_cast<int>(block.getNumSamples()));
+    };
+
+    const auto runPath = [&runOverlay](OverlayFilterChainT<StateType>& chain, juce::dsp::Oversampling<StateType>* oversampling,
+        juce::AudioBuffer<StateType>& buffer)
+    {
+        juce::dsp::AudioBlock<StateType> block(buffer);
+
+        if (oversampling == nullptr)
+        {
+            runOverlay(chain, block);
+            return;
+        }
+
+        runOverlay(chain, oversampling->processSamplesUp(block));
+        oversampling->processSamplesDown(block);
+    };
+
+    if (engine.overlayFadeRemaining <= 0)
+    {
+        runPath(engine.overlayChain, engine.overlayOversampling, wet);
+        return;
+    }
+
+    // the oversampling just switched, run both ways and crossfade from the old one
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::copy(engine.overlayScratch.getWritePointer(channel), wet.getReadPointer(channel), numSamples);
+
+    juce::AudioBuffer<StateType> previous(engine.overlayScratch.getArrayOfWritePointers(), numChannels, numSamples);
+    runPath(engine.fadingOverlayChain, engine.fadingOverlayOversampling, previous);
+    runPath(engine.overlayChain, engine.overlayOversampling, wet);
+
+    const auto fadeLength = static_cast<StateType>(juce::jmax(1, qualityFadeSamples));
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* out = wet.getWritePointer(channel);
+        const auto* other = previous.getReadPointer(channel);
+        int remaining = engine.overlayFadeRemaining;
+
+        for (int sample = 0; sample < numSamples; ++sample, remaining = juce::jmax(0, remaining - 1))
+        {
+            // weight of the path being switched to
+            const auto t = StateType(1) - static_cast<StateType>(remaining) / fadeLength;
+            out[sample] = other[sample] + (out[sample] - other[sample]) * t;
+        }
+    }
+
+    engine.overlayFadeRemaining = juce::jmax(0, engine.overlayFadeRemaining - numSamples);
+}
+
+template <typename StateType>
+void DSPWrapper::processOverlayFading(Engine<StateType>& engine, juce::AudioBuffer<StateType>& wet, float start, float end)
+{
+    if (start >= 1.0f && end >= 1.0f)
+    {
+        processOverlay(engine, wet);
+        return;
+    }
+
+    const int numChannels = wet.getNumChannels();
+    const int numSamples = wet.getNumSamples();
+
+    // the wet signal without the overlay, to fade from
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::copy(engine.overlayBypass.getWritePointer(channel), wet.getReadPointer(channel), numSamples);
+
+    processOverlay(engine, wet);
+
+    const auto step = static_cast<StateType>(end - start) / static_cast<StateType>(numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* out = wet.getWritePointer(channel);
+        const auto* bypass = engine.overlayBypass.getReadPointer(channel);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const auto t = static_cast<StateType>(start) + static_cast<StateType>(sample + 1) * step;
+            out[sample] = bypass[sample] + (out[sample] - bypass[sample]) * t;
+        }
+    }
+}
+
+void DSPWrapper::postTuning(const ReverbTuning& tuning)
+{
+    const juce::SpinLock::ScopedLockType lock(pendingTuningLock);
+    pendingTuning = tuning;
+    hasPendingTuning.store(true, std::memory_order_release);
+}
+
+void DSPWrapper::updateTuning()
+{
+    // the parameter values go through the host, so compare with a little slack
+    const auto matches = [this](const ReverbTuning& tuning)
+    {
+        return std::abs(tuning.size - lastSize) < 1.0e-4f
+            && std::abs(tuning.decay - lastDecay) < 1.0e-4f
+            && std::abs(tuning.bands.low - lastBands.low) < 1.0e-4f
+            && std::abs(tuning.bands.mid - lastBands.mid) < 1.0e-4f
+            && std::abs(tuning.bands.high - lastBands.high) < 1.0e-4f
+            && tuning.sampleRate == currentSampleRate.load(std::memory_order_relaxed)
+            && tuning.networkRate == activeTuning.networkRate;
+    };
+
+    if (matches(activeTuning))
+        return;
+
+    ReverbTuning next;
+    bool precomputed = false;
+
+    if (hasPendingTuning.load(std::memory_order_acquire))
+    {
+        // never wait on the loader, compute it here instead if it's busy
+        const juce::SpinLock::ScopedTryLockType lock(pendingTuningLock);
+
+        if (lock.isLocked() && matches(pendingTuning))
+        {
+            next = pendingTuning;
+            precomputed = true;
+            hasPendingTuning.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    if (!precomputed)
+        next = CustomReverb::makeTuning(lastSize, lastDecay, currentSampleRate.load(std::memory_order_relaxed), lastBands, isNetworkRateLimited());
+
+    activeTuning = next;
+
+    if (floatEngine != nullptr)
+        floatEngine->reverb.setTuning(activeTuning, tuningRampSamples);
+
+    if (doubleEngine != nullptr)
+        doubleEngine->reverb.setTuning(activeTuning, tuningRampSamples);
+
+    tailSeconds.store(activeTuning.tailSeconds, std::memory_order_relaxed);
+}
+
+float DSPWrapper::getPreDelayMs() const
+{
+    if (!juce::isPositiveAndBelow(preDelaySyncIndex, static_cast<int>(preDelaySyncBeats.size())) || preDelaySyncIndex == 0)
+        return lastPreDelayMs;
+
+    // beats at the host tempo, anything longer than the line holds is clamped
+    const double ms = preDelaySyncBeats[static_cast<size_t>(preDelaySyncIndex)] * 60000.0 / bpm;
+    return static_cast<float>(juce::jmin(ms, static_cast<double>(EarlyReflections::maxPreDelayMs)));
+}
+
+void DSPWrapper::processBlock(juce::AudioBuffer<float>& buffer, const juce::AudioBuffer<float>* sidechain)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (precision == Precision::single && floatEngine != nullptr)
+        processInChunks(buffer, sidechain, *floatEngine);
+    else if (doubleEngine != nullptr)
+        processInChunks(buffer, sidechain, *doubleEngine);
+    else
+        jassertfalse;   // not prepared
+
+    updateGovernor(buffer.getNumSamples(), juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+void DSPWrapper::processBlock(juce::AudioBuffer<double>& buffer, const juce::AudioBuffer<double>* sidechain)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (doubleEngine != nullptr)
+        processInChunks(buffer, sidechain, *doubleEngine);
+    else if (floatEngine != nullptr)
+        processInChunks(buffer, sidechain, *floatEngine);
+    else
+        jassertfalse;   // not prepared
 
-    
-    customReverb.prepare(sampleRate, numChannels);
-    overlayChain.setActiveFilter(std::make_unique<VileFilter>());
-    overlayChain.setDrive(10.0f); 
+    updateGovernor(buffer.getNumSamples(), juce::Time::getHighResolutionTicks() - startTicks);
 }
-void DSPWrapper::processBlock(juce::AudioBuffer<float>& buffer)
+
+template <typename SampleType, typename StateType>
+void DSPWrapper::processInChunks(juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>* sidechain, Engine<StateType>& engine)
+{
+    // the host went over the block size or channel count it gave prepareToPlay. the scratch
+    // stays the size it was made, the block goes through in pieces that fit it
+    const int maxChunkSize = engine.wetBuffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), engine.wetBuffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+    jassert(numChannels == buffer.getNumChannels());
+
+    if (numSamples <= maxChunkSize && numChannels == buffer.getNumChannels())
+    {
+        process(buffer, sidechain, engine);
+        return;
+    }
+
+    for (int start = 0; start < numSamples; start += maxChunkSize)
+    {
+        const int count = juce::jmin(maxChunkSize, numSamples - start);
+
+        // these refer to the host's memory, they don't allocate
+        juce::AudioBuffer<SampleType> chunk(buffer.getArrayOfWritePointers(), numChannels, start, count);
+
+        if (sidechain != nullptr)
+        {
+            const juce::AudioBuffer<SampleType> sidechainChunk(const_cast<SampleType* const*>(sidechain->getArrayOfReadPointers()),
+                                                               sidechain->getNumChannels(), start, count);
+            process(chunk, &sidechainChunk, engine);
+        }
+        else
+        {
+            process<SampleType>(chunk, nullptr, engine);
+        }
+    }
+}
+
+template <typename SampleType, typename StateType>
+void DSPWrapper::process(juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>* sidechain, Engine<StateType>& engine)
 {
     juce::ScopedNoDenormals noDenormals;
 
@@ -21,60 +387,117 @@ void DSPWrapper::processBlock(juce::AudioBuffer<float>& buffer)
     const int numSamples = buffer.getNumSamples();
     jassert(numChannels > 0 && numSamples > 0);
 
-    // Create a working copy (wetBuffer) of the input buffer.
-    juce::AudioBuffer<float> wetBuffer(buffer);
+    auto& wetBuffer = engine.wetBuffer;
 
-    // Always ensure wetBuffer starts as a copy of the dry signal
-    wetBuffer.makeCopyOf(buffer);
+    // Apply width and size parameters unconditionally, ramped per block
+    updateTuning();
 
-    // Apply width and size parameters unconditionally
-    customReverb.setWidth(lastWidth);
-    customReverb.setSize(lastSize);
+    if (const auto quality = getTargetQuality(); quality != engine.quality)
+        applyQuality(engine, quality, qualityFadeSamples);
+
+    sizeSmoothed.setTargetValue(lastSize);
+    widthSmoothed.setTargetValue(lastWidth);
+    mixSmoothed.setTargetValue(lastMix);
+    decaySmoothed.setTargetValue(lastDecay);
+    overlayOnSmoothed.setTargetValue(overlayOn ? 1.0f : 0.0f);
+
+    engine.reverb.setSize(sizeSmoothed.skip(numSamples));
+    engine.reverb.setWidth(widthSmoothed.skip(numSamples));
+    const float overlayMix = overlayMixSmoothed.skip(numSamples);
+    engine.overlayChain.setMix(overlayMix);
+    engine.fadingOverlayChain.setMix(overlayMix);
+
+    preDelaySmoothed.setTargetValue(getPreDelayMs());
+    const float preDelayMs = preDelaySmoothed.skip(numSamples);
+    engine.reverb.setPreDelay(static_cast<float>(preDelayMs * getSampleRate() / 1000.0));
+    preDelaySeconds.store(preDelayMs / 1000.0, std::memory_order_relaxed);
+
+    const float mixStart = mixSmoothed.getCurrentValue();
+    const float mixEnd = mixSmoothed.skip(numSamples);
+    const float decay = decaySmoothed.skip(numSamples);
+    const float overlayOnStart = overlayOnSmoothed.getCurrentValue();
+    const float overlayOnEnd = overlayOnSmoothed.skip(numSamples);
 
     // only process if mix > 0
-    if (lastMix > 0.0f)
+    const bool wetActive = mixStart > 0.0f || mixEnd > 0.0f;
+
+    // the key is read before anything touches the buffer, so without a sidechain it's the dry
+    // input. the envelope keeps following it while the wet path is off
+    const float duckStart = ducker.getGain();
+    const float duckEnd = ducker.process(sidechain != nullptr && sidechain->getNumChannels() > 0 ? *sidechain : buffer, numSamples);
+
+    if (wetActive)
     {
+        // the one copy of the dry signal, the reverb and overlay then work in place on it
+        for (int channel = 0; channel < numChannels; ++channel)
+            copySamples(wetBuffer.getWritePointer(channel), buffer.getReadPointer(channel), numSamples);
+
+        // refers to the scratch memory, doesn't allocate
+        juce::AudioBuffer<StateType> wet(wetBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+
         // process reverb, ensuring width and size are applied
-        customReverb.processBlock(wetBuffer, lastDecay, lastMix);
+        {
+            ANGELS_PERF_STAGE(perfMonitor, reverb);
+            engine.reverb.processBlock(wet, decay, mixEnd);
+        }
 
-        // apply overlay processing only if overlayOn is enabled
-        if (overlayOn)
+        // the overlay fades in and out when it's switched rather than cutting, and doesn't run
+        // at all once it's faded out
+        if (overlayOnStart > 0.0f || overlayOnEnd > 0.0f)
         {
-            for (int channel = 0; channel < numChannels; ++channel)
-            {
-                auto* wetChannel = wetBuffer.getWritePointer(channel);
-                for (int sample = 0; sample < numSamples; ++sample)
-                {
-                    wetChannel[sample] = overlayChain.processSample(wetChannel[sample]);
-                }
-            }
+            ANGELS_PERF_STAGE(perfMonitor, overlay);
+            processOverlayFading(engine, wet, overlayOnStart, overlayOnEnd);
         }
     }
 
-    // Combine the dry (original) and wet (processed) signals
-    for (int channel = 0; channel < numChannels; ++channel)
+    // dry/wet blend and output gain in a single pass over the buffer, worked out in the wider
+    // of the buffer and engine types, then the limiter. the loops have no per-sample branch
+    ANGELS_PERF_STAGE(perfMonitor, output);
+
+    using MixType = std::conditional_t<(sizeof(SampleType) > sizeof(StateType)), SampleType, StateType>;
+
+    const auto gain = static_cast<MixType>(outputGain);
+
+    if (!wetActive)
+    {
+        // mix is 0 at both ends of the block, only the output gain is left
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel), static_cast<SampleType>(gain), numSamples);
+    }
+    else
     {
-        auto* dryChannel = buffer.getReadPointer(channel);    // Original signal
-        auto* wetChannel = wetBuffer.getReadPointer(channel); // Processed signal
-        auto* outputChannel = buffer.getWritePointer(channel);
+        // while the mix or the ducking ramp both gains step per sample, otherwise the steps are 0.
+        // the ducking only ever scales the wet gain
+        const auto wetStart = static_cast<MixType>(mixStart) * static_cast<MixType>(duckStart);
+        const auto wetEnd = static_cast<MixType>(mixEnd) * static_cast<MixType>(duckEnd);
+        const auto dryGain = (MixType(1) - static_cast<MixType>(mixStart)) * gain;
+        const auto wetGain = wetStart * gain;
+        const auto dryStep = static_cast<MixType>(mixStart - mixEnd) / static_cast<MixType>(numSamples) * gain;
+        const auto wetStep = (wetEnd - wetStart) / static_cast<MixType>(numSamples) * gain;
 
-        for (int sample = 0; sample < numSamples; ++sample)
+        for (int channel = 0; channel < numChannels; ++channel)
         {
-            if (lastMix > 0.0f)
+            auto* outputChannel = buffer.getWritePointer(channel);
+            const auto* wetChannel = wetBuffer.getReadPointer(channel);
+
+            // the buffer and engine agree except in mixed precision, then it's the scalar loop
+            if constexpr (std::is_same_v<SampleType, StateType>)
             {
-                // Blend dry and wet signals based on lastMix
-                outputChannel[sample] = (1.0f - lastMix) * dryChannel[sample] + lastMix * wetChannel[sample];
+                SimdKernels::get<SampleType>().mix(outputChannel, wetChannel, numSamples, wetGain, wetStep, dryGain, dryStep);
             }
             else
             {
-                // Pass through dry signal untouched if mix is 0
-                outputChannel[sample] = dryChannel[sample];
+                for (int sample = 0; sample < numSamples; ++sample)
+                {
+                    const auto index = static_cast<MixType>(sample + 1);
+                    outputChannel[sample] = static_cast<SampleType>(static_cast<MixType>(outputChannel[sample]) * (dryGain + index * dryStep)
+                                                                    + static_cast<MixType>(wetChannel[sample]) * (wetGain + index * wetStep));
+                }
             }
         }
     }
 
-    // Flush any lingering denormalized values
-    buffer.applyGain(1.0f);
+    getLimiter<SampleType>().process(buffer);
 }
 
 void DSPWrapper::setParameter(const juce::String& paramID, float value)
@@ -82,23 +505,48 @@ void DSPWrapper::setParameter(const juce::String& paramID, float value)
     // Handle parameters with consistent usage of ParameterIDs.
     if (paramID == ParameterIDs::size)
     {
-        customReverb.setSize(value);
         lastSize = value;
     }
     else if (paramID == ParameterIDs::width)
     {
-        customReverb.setWidth(value);
         lastWidth = value;
     }
     else if (paramID == ParameterIDs::mix)
     {
-        overlayChain.setMix(value);
         lastMix = value;
     }
     else if (paramID == ParameterIDs::damp)
     {
         lastDecay = value;
     }
+    else if (paramID == ParameterIDs::preDelay)
+    {
+        lastPreDelayMs = juce::jlimit(0.0f, EarlyReflections::maxPreDelayMs, value);
+    }
+    else if (paramID == ParameterIDs::duck)
+    {
+        ducker.setAmount(value);
+    }
+    else if (paramID == ParameterIDs::duckRelease)
+    {
+        ducker.setRelease(value);
+    }
+    else if (paramID == ParameterIDs::lowDecay)
+    {
+        lastBands.low = value;
+    }
+    else if (paramID == ParameterIDs::midDecay)
+    {
+        lastBands.mid = value;
+    }
+    else if (paramID == ParameterIDs::highDecay)
+    {
+        lastBands.high = value;
+    }
+    else if (paramID == ParameterIDs::preDelaySync)
+    {
+        preDelaySyncIndex = static_cast<int>(value + 0.5f);
+    }
     else if (paramID.trim() == "OVERLAY_ON")
     {
         overlayOn = (value > 0.0f);
@@ -3,32 +3,226 @@
 #include "CustomReverb.h"
 #include "OverlayFilterChain.h"
 #include "VileFilter.h"
+#include "Ducker.h"
+#include "TruePeakLimiter.h"
+#include "QualityGovernor.h"
+#include "PerformanceMonitor.h"
 #include <JuceHeader.h>
 
 class DSPWrapper
 {
 public:
-    // init and audio processing.
-    void prepare(double sampleRate, int numChannels);
-    void processBlock(juce::AudioBuffer<float>& buffer);
+    // what the reverb network runs and keeps its state in. single is the float path,
+    // mixed keeps float buffers but runs the network in double, full is double throughout
+    // and is what double precision hosts get
+    enum class Precision
+    {
+        single,
+        mixed,
+        full
+    };
+
+    // how much of the network runs. eco halves the combs, high adds two allpass diffusion
+    // stages and runs the overlay 2x oversampled. render is never chosen, it's what offline
+    // bounces get: four extra allpasses and the overlay 4x oversampled
+    enum class Quality
+    {
+        eco,
+        normal,
+        high,
+        render
+    };
+
+    // init and audio processing. the ducker keys off sidechain if there is one, otherwise
+    // off the dry input
+    void prepare(double sampleRate, int numChannels, int maxBlockSize, Precision newPrecision = Precision::single);
+    void processBlock(juce::AudioBuffer<float>& buffer, const juce::AudioBuffer<float>* sidechain = nullptr);
+    void processBlock(juce::AudioBuffer<double>& buffer, const juce::AudioBuffer<double>* sidechain = nullptr);
+
+    // the dry input, delayed by the limiter's latency, for the host's bypass
+    void processBlockBypassed(juce::AudioBuffer<float>& buffer) { floatLimiter.processBypassed(buffer); }
+    void processBlockBypassed(juce::AudioBuffer<double>& buffer) { doubleLimiter.processBypassed(buffer); }
+
     void setParameter(const juce::String& paramID, float value);
 
+    Precision getPrecision() const { return precision; }
+
+    // the tier to run at, the governor can only take it lower. both are safe to call from
+    // any thread, the change is picked up and crossfaded on the next block
+    void setQuality(Quality newQuality) { requestedQuality.store(newQuality, std::memory_order_relaxed); }
+    void setGovernorEnabled(bool shouldBeEnabled) { governorEnabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+
+    // the tier actually running, after the governor
+    Quality getActiveQuality() const { return activeQuality.load(std::memory_order_relaxed); }
+
+    // while the host bounces offline the render tier runs and the governor is off, there's
+    // no deadline to keep. everything it needs is made in prepare, switching doesn't allocate
+    void setOfflineRendering(bool isOffline) { offlineRendering.store(isOffline, std::memory_order_relaxed); }
+
+    // above 48k the late network runs decimated, see CustomReverbT::getDecimationFactor.
+    // takes effect on the next prepare, the processor re-prepares when it changes
+    void setNetworkRateLimited(bool shouldBeLimited) { networkRateLimited.store(shouldBeLimited, std::memory_order_relaxed); }
+    bool isNetworkRateLimited() const { return networkRateLimited.load(std::memory_order_relaxed); }
 
     void setOverlayMix(float newMix)
     {
-        overlayChain.setMix(newMix);
+        overlayMixSmoothed.setTargetValue(newMix);
     }
 
+    // reverb tuning worked out ahead of time, from the preset loader's background thread.
+    // the audio thread picks it up once the parameters it was made for arrive, instead of
+    // computing its own
+    void postTuning(const ReverbTuning& tuning);
+
+    double getSampleRate() const { return currentSampleRate.load(std::memory_order_relaxed); }
+
+    // the limiter's lookahead, the same for every tier and precision
+    int getLatencySamples() const { return floatLimiter.getLatencySamples(); }
+
+    // ring-down time of the current tuning plus the pre-delay, safe to call from any thread
+    double getTailLengthSeconds() const
+    {
+        return tailSeconds.load(std::memory_order_relaxed) + preDelaySeconds.load(std::memory_order_relaxed);
+    }
+
+    // host tempo for the synced pre-delay
+    void setTempo(double newBpm)
+    {
+        if (newBpm > 0.0)
+            bpm = newBpm;
+    }
+
+    // pre-delay sync choices in quarter notes, index 0 is off. same order as the parameter
+    static constexpr std::array<double, 7> preDelaySyncBeats{ 0.0, 0.0625, 0.125, 0.25, 0.5, 1.0, 2.0 };
+
+#if ANGELS_PERF_INSTRUMENTATION
+    void setPerformanceMonitor(PerformanceMonitor* newMonitor) { perfMonitor = newMonitor; }
+#endif
+
 private:
+    // everything that runs at the chosen precision
+    template <typename StateType>
+    struct Engine
+    {
+        CustomReverbT<StateType> reverb;
+
+        // the overlay keeps state per channel. while the oversampling crossfades the path
+        // fading out keeps running with the chain it had, see applyQuality
+        OverlayFilterChainT<StateType> overlayChain, fadingOverlayChain;
+
+        // wet path scratch, sized in prepare so processBlock never allocates
+        juce::AudioBuffer<StateType> wetBuffer;
+
+        // oversampling for the high and render tiers, made in prepare whatever the tier so
+        // switching never allocates. nullptr runs the overlay at the base rate. the scratch
+        // holds the path fading out while the two crossfade
+        std::unique_ptr<juce::dsp::Oversampling<StateType>> oversampling2x, oversampling4x;
+        juce::dsp::Oversampling<StateType>* overlayOversampling = nullptr;
+        juce::dsp::Oversampling<StateType>* fadingOverlayOversampling = nullptr;
+        juce::AudioBuffer<StateType> overlayScratch;
+        int overlayFadeRemaining = 0;
+
+        // the wet signal before the overlay while it's switched on or off, see processOverlayFading
+        juce::AudioBuffer<StateType> overlayBypass;
+
+        Quality quality = Quality::normal;
+    };
+
+    template <typename StateType>
+    void prepareEngine(Engine<StateType>& engine, double sampleRate, int numChannels, int maxBlockSize);
+
+    template <typename StateType>
+    void applyQuality(Engine<StateType>& engine, Quality newQuality, int fadeSamples);
+
+    template <typename StateType>
+    void processOverlay(Engine<StateType>& engine, juce::AudioBuffer<StateType>& wet);
+
+    // processOverlay, crossfaded with the wet signal it was given from start to end
+    template <typename StateType>
+    void processOverlayFading(Engine<StateType>& engine, juce::AudioBuffer<StateType>& wet, float start, float end);
+
+    Quality getTargetQuality() const;
+    void updateGovernor(int numSamples, juce::int64 elapsedTicks);
+
+    // process, in pieces no bigger than the engine was prepared for
+    template <typename SampleType, typename StateType>
+    void processInChunks(juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>* sidechain, Engine<StateType>& engine);
+
+    template <typename SampleType, typename StateType>
+    void process(juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>* sidechain, Engine<StateType>& engine);
+
+    void updateTuning();
+    float getPreDelayMs() const;
+
+#if ANGELS_PERF_INSTRUMENTATION
+    PerformanceMonitor* perfMonitor = nullptr;
+#endif
     
-    CustomReverb customReverb;
-    OverlayFilterChain overlayChain;
+    // only the engine for the current precision exists
+    std::unique_ptr<Engine<float>> floatEngine;
+    std::unique_ptr<Engine<double>> doubleEngine;
+    Precision precision = Precision::single;
+
+    // wet path gain reduction, runs at the buffer's precision whatever the engine's
+    Ducker ducker;
+
+    std::atomic<Quality> requestedQuality{ Quality::normal };
+    std::atomic<Quality> activeQuality{ Quality::normal };
+    std::atomic<bool> governorEnabled{ true };
+    std::atomic<bool> offlineRendering{ false };
+    std::atomic<bool> networkRateLimited{ true };
+    QualityGovernor governor;
+    static constexpr double qualityFadeSeconds = 0.05;
+    int qualityFadeSamples = 0;
+
+    // output gain folded into the mix, the level the old 0.75 gain, tanh(x * 0.7) / tanh(0.7)
+    // and 0.7 gain stage had below clipping. the limiter takes care of the overs
+    const float outputGain = 0.75f * 0.7f * 0.7f / std::tanh(0.7f);
+
+    // at the buffer's precision, both are prepared so a host switching doesn't allocate
+    TruePeakLimiterT<float> floatLimiter;
+    TruePeakLimiterT<double> doubleLimiter;
+
+    template <typename SampleType>
+    TruePeakLimiterT<SampleType>& getLimiter()
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return floatLimiter;
+        else
+            return doubleLimiter;
+    }
+
+    // parameter changes ramp over this long, so automation and preset recall don't click
+    static constexpr double smoothingSeconds = 0.05;
+    static constexpr double tuningRampSeconds = 0.1;
+
+    juce::SmoothedValue<float> sizeSmoothed{ 1.0f };
+    juce::SmoothedValue<float> widthSmoothed{ 1.0f };
+    juce::SmoothedValue<float> mixSmoothed{ 0.5f };
+    juce::SmoothedValue<float> decaySmoothed{ 0.0f };
+    juce::SmoothedValue<float> overlayMixSmoothed{ 1.0f };
+    juce::SmoothedValue<float> overlayOnSmoothed{ 1.0f };   // 1 on, 0 off
+    juce::SmoothedValue<float> preDelaySmoothed{ 0.0f };     // ms
+
+    // tuning the reverb is gliding to, and the one waiting in the mailbox
+    ReverbTuning activeTuning;
+    ReverbTuning pendingTuning;
+    juce::SpinLock pendingTuningLock;
+    std::atomic<bool> hasPendingTuning{ false };
+    std::atomic<double> currentSampleRate{ 44100.0 };
+    std::atomic<double> tailSeconds{ 0.0 };
+    std::atomic<double> preDelaySeconds{ 0.0 };
+    int tuningRampSamples = 0;
 
-    // cached parameter values.
+    // cached parameter values, the targets of the smoothers above.
     float lastSize = 1.0f;
     float lastWidth = 1.0f;
     float lastMix = 0.5f;
     float lastDecay = 0.0f;  // holds the Ddecay slider value.
+    float lastPreDelayMs = 0.0f;
+    DecayBands lastBands;
+    int preDelaySyncIndex = 0;
+    double bpm = 120.0;
 
     // true if overlay processing  enabled.
     bool overlayOn = true;
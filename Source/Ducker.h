@@ -0,0 +1,59 @@
+#pragma once
+#include <JuceHeader.h>
+
+// gain for the wet path that follows a key signal, the dry input or a sidechain. the level
+// is one peak scan per block instead of a per-sample detector, attack is instant and the
+// release is a one-pole worked out per block. there's no lookahead, the block's own peak
+// sets the gain for its end and the caller ramps to it across the block
+class Ducker
+{
+public:
+    static constexpr float maxDepthDb = 24.0f;
+    static constexpr float thresholdDb = -40.0f;     // key level where ducking starts, full depth at 0 dBFS
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    void reset()
+    {
+        envelope = 0.0f;
+        gain = 1.0f;
+    }
+
+    // 0 turns it off
+    void setAmount(float newAmount) { amount = juce::jlimit(0.0f, 1.0f, newAmount); }
+    void setRelease(float newReleaseMs) { releaseSeconds = juce::jmax(0.001f, newReleaseMs * 0.001f); }
+
+    // gain at the end of the last block processed, where the next block ramps from
+    float getGain() const { return gain; }
+
+    template <typename SampleType>
+    float process(const juce::AudioBuffer<SampleType>& key, int numSamples)
+    {
+        if (amount <= 0.0f || key.getNumChannels() == 0)
+        {
+            reset();
+            return gain;
+        }
+
+        const auto peak = static_cast<float>(key.getMagnitude(0, numSamples));
+        const auto release = static_cast<float>(std::exp(-numSamples / (releaseSeconds * sampleRate)));
+        envelope = juce::jmax(peak, envelope * release);
+
+        const float levelDb = juce::Decibels::gainToDecibels(envelope, thresholdDb);
+        const float over = juce::jlimit(0.0f, 1.0f, (levelDb - thresholdDb) / -thresholdDb);
+
+        gain = juce::Decibels::decibelsToGain(-amount * maxDepthDb * over);
+        return gain;
+    }
+
+private:
+    double sampleRate = 44100.0;
+    float amount = 0.0f;
+    float releaseSeconds = 0.25f;
+    float envelope = 0.0f;
+    float gain = 1.0f;
+};
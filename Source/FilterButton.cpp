@@ -2,7 +2,6 @@
 
 #include "FilterButton.h"
 #include "MyColours.h"
-#include <BinaryData.h>
 
 FilterButton::FilterButton(juce::RangedAudioParameter& param, juce::UndoManager* um)
     : audioParam(param)
@@ -16,8 +15,8 @@ FilterButton::FilterButton(juce::RangedAudioParameter& param, juce::UndoManager*
 
    
 
-    offImage = juce::ImageCache::getFromMemory(BinaryData::BUTTONOFF_png, BinaryData::BUTTONOFF_pngSize);
-    onImage = juce::ImageCache::getFromMemory(BinaryData::BUTTONON_png, BinaryData::BUTTONON_pngSize);
+    offImage = assets->getImage(AssetCache::ImageId::buttonOff);
+    onImage = assets->getImage(AssetCache::ImageId::buttonOn);
 
     jassert(!onImage.isNull());
     jassert(!offImage.isNull());
@@ -34,12 +33,12 @@ void FilterButton::resized()
 void FilterButton::paint(juce::Graphics& g)
 {
     // choose image based on the button's state.
-    const juce::Image& currentImage = state ? onImage : offImage;
+    const juce::Image& sourceImage = state ? onImage : offImage;
 
-    if (!currentImage.isNull())
+    if (!sourceImage.isNull())
     {
-        float imageW = static_cast<float>(currentImage.getWidth());
-        float imageH = static_cast<float>(currentImage.getHeight());
+        float imageW = static_cast<float>(sourceImage.getWidth());
+        float imageH = static_cast<float>(sourceImage.getHeight());
 
         // compute the factor that would exactly fit the image inside the button.
         float computedScale = std::min(getWidth() / imageW, getHeight() / imageH);
@@ -56,6 +55,11 @@ void FilterButton::paint(juce::Graphics& g)
         int offsetX = (getWidth() - destWidth) / 2;
         int offsetY = (getHeight() - destHeight) / 2;
 
+        // pre-scaled to the physical size by the shared cache, then drawn 1:1
+        const auto pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const auto currentImage = assets->getScaledImage(state ? AssetCache::ImageId::buttonOn : AssetCache::ImageId::buttonOff,
+            juce::roundToInt(destWidth * pixelScale), juce::roundToInt(destHeight * pixelScale));
+
         // draw the image with the new dimensions.
         g.drawImage(currentImage,
             offsetX, offsetY, destWidth, destHeight,   // destination rectangle
@@ -4,6 +4,7 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_gui_basics/juce_gui_basics.h>
+#include "AssetCache.h"
 
 class FilterButton final : public juce::Component
 {
@@ -39,6 +40,7 @@ private:
     juce::RangedAudioParameter& audioParam;
     juce::ParameterAttachment paramAttachment;
 
+    juce::SharedResourcePointer<AssetCache> assets;
     juce::Image onImage;
     juce::Image offImage;
 
@@ -20,6 +20,24 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
+#if JUCE_UNIT_TESTS
+        // --unit-tests runs the project's tests without a window and quits, failing if any did
+        if (commandLine.contains("--unit-tests"))
+        {
+            juce::UnitTestRunner runner;
+            runner.runTestsInCategory("angels");
+
+            int failures = 0;
+
+            for (int i = 0; i < runner.getNumResults(); ++i)
+                failures += runner.getResult(i)->failures;
+
+            setApplicationReturnValue(failures > 0 ? 1 : 0);
+            quit();
+            return;
+        }
+#endif
+
         mainWindow.reset(new MainWindow(getApplicationName()));
     }
 
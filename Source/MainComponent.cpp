@@ -2,6 +2,7 @@
 #include "EditorContent.h"
 #include "PluginEditor.h"
 #include "PluginProcessor.h"
+#include "CubeGeometry.h"
 
 
 
@@ -30,17 +31,20 @@ MainComponent::MainComponent()
      /*openGLContext.setContinuousRepainting(false); 
      openGLContext.detach(); */
 
+    // watches for a GL context that never comes up, and drives the software renderer if it doesn't
+    lastTimerMs = juce::Time::getMillisecondCounterHiRes();
+    startTimerHz(30);
 
 }
 
 MainComponent::~MainComponent()
 {
+    stopTimer();
     openGLContext.detach();
     shutdownOpenGL();
 
     /*openGLContext.setRenderer(nullptr); 
     cubeShaderProgram.reset();
-    motionBlurShaderProgram.reset();
     blurShaderProgram.reset();*/
 
 }
@@ -87,18 +91,26 @@ void MainComponent::initialise()
     const char* cubeVertexShaderSource = R"(
     #version 330 core
     layout(location = 0) in vec3 aPosition;
+    layout(location = 1) in vec2 aScale;    // per instance: x = current, y = previous frame
+    layout(location = 2) in vec4 aColor;    // per instance: rgb + alpha
 
-    uniform mat4 uProjectionMatrix;
-    uniform mat4 uModelViewMatrix;
-    uniform mat4 uPrevModelViewMatrix;
+    layout(std140) uniform SceneBlock
+    {
+        mat4 uProjectionMatrix;
+        mat4 uViewMatrix;
+        mat4 uPrevViewMatrix;
+        vec4 uParams;
+    };
 
     out vec4 vCurrentPos;
     out vec4 vPrevPos;
+    out vec4 vColor;
 
     void main()
     {
-        vCurrentPos = uProjectionMatrix * uModelViewMatrix * vec4(aPosition, 1.0);
-        vPrevPos = uProjectionMatrix * uPrevModelViewMatrix * vec4(aPosition, 1.0);
+        vCurrentPos = uProjectionMatrix * uViewMatrix * vec4(aPosition * aScale.x, 1.0);
+        vPrevPos = uProjectionMatrix * uPrevViewMatrix * vec4(aPosition * aScale.y, 1.0);
+        vColor = aColor;
         gl_Position = vCurrentPos;
     }
     )";
@@ -108,13 +120,11 @@ void MainComponent::initialise()
     #version 330 core
     in vec4 vCurrentPos;
     in vec4 vPrevPos;
+    in vec4 vColor;
 
     out vec4 FragColor;
     layout(location = 1) out vec2 MotionVector;
 
-    uniform vec3 uColor = vec3(1.0, 1.0, 1.0); // Black cube
-    uniform float uAlpha; // Alpha value for transparency
-
     void main()
     {
         // Compute normalized device coordinates
@@ -124,7 +134,7 @@ void MainComponent::initialise()
         // Store motion vector
         MotionVector = (currentPos - prevPos) * 0.5; // Scale to enhance visibility
 
-        FragColor = vec4(uColor, uAlpha);
+        FragColor = vColor;
     }
     )";
 
@@ -135,6 +145,7 @@ void MainComponent::initialise()
     {
         juce::Logger::writeToLog("Failed to compile cube vertex shader:");
         juce::Logger::writeToLog(cubeShaderProgram->getLastError());
+        glInitialiseFailed = true;
         return;
     }
 
@@ -142,6 +153,7 @@ void MainComponent::initialise()
     {
         juce::Logger::writeToLog("Failed to compile cube fragment shader:");
         juce::Logger::writeToLog(cubeShaderProgram->getLastError());
+        glInitialiseFailed = true;
         return;
     }
 
@@ -149,20 +161,15 @@ void MainComponent::initialise()
     {
         juce::Logger::writeToLog("Failed to link cube shader program:");
         juce::Logger::writeToLog(cubeShaderProgram->getLastError());
+        glInitialiseFailed = true;
         return;
     }
 
-    // get attribute and uniform locations for the cube shader
+    // get attribute locations for the cube shader, everything else comes from the instance VBO and SceneBlock
     cubePositionAttribute.reset(new juce::OpenGLShaderProgram::Attribute(*cubeShaderProgram, "aPosition"));
 
-    cubeProjectionMatrixUniform.reset(new juce::OpenGLShaderProgram::Uniform(*cubeShaderProgram, "uProjectionMatrix"));
-    cubeModelViewMatrixUniform.reset(new juce::OpenGLShaderProgram::Uniform(*cubeShaderProgram, "uModelViewMatrix"));
-    cubePrevModelViewMatrixUniform.reset(new juce::OpenGLShaderProgram::Uniform(*cubeShaderProgram, "uPrevModelViewMatrix"));
-    cubeColorUniform.reset(new juce::OpenGLShaderProgram::Uniform(*cubeShaderProgram, "uColor"));
-    cubeAlphaUniform.reset(new juce::OpenGLShaderProgram::Uniform(*cubeShaderProgram, "uAlpha"));
-
-    // motionblur shader
-    const char* motionBlurVertexShaderSource = R"(
+    // post-processing shader: blur, plus motion blur when enabled, straight to the screen
+    const char* blurVertexShaderSource = R"(
     #version 330 core
     layout(location = 0) in vec2 aPosition;
     out vec2 vTexCoord;
@@ -174,107 +181,66 @@ void MainComponent::initialise()
     }
     )";
 
-    const char* motionBlurFragmentShaderSource = R"(
+    const char* blurFragmentShaderSource = R"(
     #version 330 core
     in vec2 vTexCoord;
     out vec4 FragColor;
 
-    uniform sampler2D uColorTexture;
+    uniform sampler2D uTexture;
     uniform sampler2D uMotionTexture;
 
-    void main()
+    layout(std140) uniform SceneBlock
     {
-        vec2 motion = texture(uMotionTexture, vTexCoord).xy;
-
-        int samples = 1;
-        vec4 color = vec4(0.0);
-        float totalWeight = 0.0;
-
-        for (int i = 0; i < samples; ++i)
-        {
-            float t = float(i) / float(samples - 1);
-            vec2 samplePos = vTexCoord - motion * t;
-            vec4 sampleColor = texture(uColorTexture, samplePos);
-            float weight = exp(-3.0 * t * t);
-            color += sampleColor * weight;
-            totalWeight += weight;
-        }
-
-        color /= totalWeight;
-        FragColor = color;
-    }
-    )";
+        mat4 uProjectionMatrix;
+        mat4 uViewMatrix;
+        mat4 uPrevViewMatrix;
+        vec4 uParams;   // x = damp, y = motion blur samples (1 = off, uMotionTexture is not bound), zw = uv scale
+    };
 
-    // create and compile the motion blur shader program
-    motionBlurShaderProgram.reset(new juce::OpenGLShaderProgram(openGLContext));
+    // 9-tap Gaussian, the centre and four taps each side. a tap step is several texels on
+    // wide or hidpi targets, so the pairs can't be folded into linearly filtered fetches
+    const float weights[5] = float[](0.18, 0.15, 0.12, 0.09, 0.05);
 
-    if (!motionBlurShaderProgram->addVertexShader(motionBlurVertexShaderSource))
+    vec3 blurAt(vec2 uv, float offset)
     {
-        juce::Logger::writeToLog("Failed to compile motion blur vertex shader:");
-        juce::Logger::writeToLog(motionBlurShaderProgram->getLastError());
-        return;
-    }
+        vec3 result = texture(uTexture, uv).rgb * weights[0];
 
-    if (!motionBlurShaderProgram->addFragmentShader(motionBlurFragmentShaderSource))
-    {
-        juce::Logger::writeToLog("Failed to compile motion blur fragment shader:");
-        juce::Logger::writeToLog(motionBlurShaderProgram->getLastError());
-        return;
-    }
+        for (int i = 1; i < 5; i++)
+        {
+            vec2 tap = vec2(float(i) * offset, 0.0);
+            result += (texture(uTexture, uv - tap).rgb + texture(uTexture, uv + tap).rgb) * weights[i];
+        }
 
-    if (!motionBlurShaderProgram->link())
-    {
-        juce::Logger::writeToLog("Failed to link motion blur shader program:");
-        juce::Logger::writeToLog(motionBlurShaderProgram->getLastError());
-        return;
+        return result;
     }
 
-    // get attribute and uniform locations for the motion blur shader
-    quadPositionAttribute.reset(new juce::OpenGLShaderProgram::Attribute(*motionBlurShaderProgram, "aPosition"));
-    motionBlurColorTextureUniform.reset(new juce::OpenGLShaderProgram::Uniform(*motionBlurShaderProgram, "uColorTexture"));
-    motionBlurMotionTextureUniform.reset(new juce::OpenGLShaderProgram::Uniform(*motionBlurShaderProgram, "uMotionTexture"));
-
-    // basic blur shader
-    const char* blurVertexShaderSource = R"(
-    #version 330 core
-    layout(location = 0) in vec2 aPosition;
-    out vec2 vTexCoord;
-
     void main()
     {
-        vTexCoord = aPosition * 0.5 + 0.5;
-        gl_Position = vec4(aPosition, 0.0, 1.0);
-    }
-    )";
+        vec2 uvScale = uParams.zw;  // the scene textures can be larger than the view
+        vec2 uv = vTexCoord * uvScale;
+        float offset = (1.0 + uParams.x * 2.0) / 300.0 * uvScale.x; // Adjusted blur strength
+        int motionSamples = int(uParams.y);
 
-    const char* blurFragmentShaderSource = R"(
-    #version 330 core
-    in vec2 vTexCoord;
-    out vec4 FragColor;
+        if (motionSamples <= 1)
+        {
+            FragColor = vec4(blurAt(uv, offset), 1.0);
+            return;
+        }
 
-    uniform sampler2D uTexture;
-    uniform float uDamp;
+        // smear along the motion vector, blurring each sample
+        vec2 motion = texture(uMotionTexture, uv).xy * uvScale;
+        vec3 color = vec3(0.0);
+        float totalWeight = 0.0;
 
-    void main()
-    {
-        float offset = (1.0 + uDamp * 2.0) / 300.0; // Adjusted blur strength
-        vec3 result = vec3(0.0);
-
-        // Expanded 9-tap Gaussian blur kernel
-        float kernel[9] = float[](0.05, 0.09, 0.12, 0.15, 0.18, 0.15, 0.12, 0.09, 0.05);
-        vec2 offsets[9] = vec2[](
-            vec2(-4.0, 0.0), vec2(-3.0, 0.0), vec2(-2.0, 0.0),
-            vec2(-1.0, 0.0), vec2(0.0, 0.0), vec2(1.0, 0.0),
-            vec2(2.0, 0.0), vec2(3.0, 0.0), vec2(4.0, 0.0)
-        );
-
-        for(int i = 0; i < 9; i++)
+        for (int i = 0; i < motionSamples; ++i)
         {
-            vec2 samplePos = vTexCoord + offsets[i] * offset;
-            result += texture(uTexture, samplePos).rgb * kernel[i];
+            float t = float(i) / float(motionSamples - 1);
+            float weight = exp(-3.0 * t * t);
+            color += blurAt(uv - motion * t, offset) * weight;
+            totalWeight += weight;
         }
 
-        FragColor = vec4(result, 1.0);
+        FragColor = vec4(color / totalWeight, 1.0);
     }
     )";
 
@@ -285,6 +251,7 @@ void MainComponent::initialise()
     {
         juce::Logger::writeToLog("Failed to compile blur vertex shader:");
         juce::Logger::writeToLog(blurShaderProgram->getLastError());
+        glInitialiseFailed = true;
         return;
     }
 
@@ -292,6 +259,7 @@ void MainComponent::initialise()
     {
         juce::Logger::writeToLog("Failed to compile blur fragment shader:");
         juce::Logger::writeToLog(blurShaderProgram->getLastError());
+        glInitialiseFailed = true;
         return;
     }
 
@@ -299,37 +267,34 @@ void MainComponent::initialise()
     {
         juce::Logger::writeToLog("Failed to link blur shader program:");
         juce::Logger::writeToLog(blurShaderProgram->getLastError());
+        glInitialiseFailed = true;
         return;
     }
 
-    // get uniform locations for the blur shader
-    blurTextureUniform.reset(new juce::OpenGLShaderProgram::Uniform(*blurShaderProgram, "uTexture"));
-    blurDampUniform.reset(new juce::OpenGLShaderProgram::Uniform(*blurShaderProgram, "uDamp"));
+    // samplers never change, so they're set once here instead of every frame
+    blurShaderProgram->use();
+    juce::OpenGLShaderProgram::Uniform(*blurShaderProgram, "uTexture").set(0);
+    juce::OpenGLShaderProgram::Uniform(*blurShaderProgram, "uMotionTexture").set(1);
 
-    // cube gemetry
+    // per-frame uniform buffer shared by both programs
+    glGenBuffers(1, &sceneUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(SceneUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, sceneUniformBinding, sceneUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-    // define the cube vertices
-    static const GLfloat cubeVertices[] = {
-        // Positions
-        -1.0f, -1.0f, -1.0f, // 0
-         1.0f, -1.0f, -1.0f, // 1
-         1.0f,  1.0f, -1.0f, // 2
-        -1.0f,  1.0f, -1.0f, // 3
-        -1.0f, -1.0f,  1.0f, // 4
-         1.0f, -1.0f,  1.0f, // 5
-         1.0f,  1.0f,  1.0f, // 6
-        -1.0f,  1.0f,  1.0f  // 7
-    };
+    for (auto* program : { cubeShaderProgram.get(), blurShaderProgram.get() })
+    {
+        const GLuint blockIndex = glGetUniformBlockIndex(program->getProgramID(), "SceneBlock");
+        if (blockIndex != GL_INVALID_INDEX)
+            glUniformBlockBinding(program->getProgramID(), blockIndex, sceneUniformBinding);
+    }
 
-    // define the indices for the cube lines (wireframe)
-    static const GLuint cubeIndices[] = {
-        // front face
-        0, 1, 1, 2, 2, 3, 3, 0,
-        // back face
-        4, 5, 5, 6, 6, 7, 7, 4,
-        // edges between front and back faces
-        0, 4, 1, 5, 2, 6, 3, 7
-    };
+    // cube gemetry
+
+    // vertices and line indices are shared with the software renderer
+    const auto& cubeVertices = CubeGeometry::vertices;
+    const auto& cubeIndices = CubeGeometry::indices;
 
     numIndices = sizeof(cubeIndices) / sizeof(GLuint);
 
@@ -351,6 +316,19 @@ void MainComponent::initialise()
     glEnableVertexAttribArray(cubePositionAttribute->attributeID);
     glVertexAttribPointer(cubePositionAttribute->attributeID, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (void*)0);
 
+    // per-instance scale and colour, one entry per cube
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeInstances), cubeInstances.data(), GL_DYNAMIC_DRAW);
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, scale));
+    glVertexAttribDivisor(1, 1);
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)offsetof(CubeInstance, colour));
+    glVertexAttribDivisor(2, 1);
+
     // unbind VAO
     glBindVertexArray(0);
 
@@ -379,60 +357,14 @@ void MainComponent::initialise()
 
     glBindVertexArray(0);
 
-    //framebuffers and textures
-
-    // fbo and textures
-    glGenFramebuffers(1, &sceneFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
-
-    // color texture
-    glGenTextures(1, &colorTexture);
-    glBindTexture(GL_TEXTURE_2D, colorTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, getWidth(), getHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
-
-    // motion vector texture
-    glGenTextures(1, &motionTexture);
-    glBindTexture(GL_TEXTURE_2D, motionTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, getWidth(), getHeight(), 0, GL_RG, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, motionTexture, 0);
-
-    // specify the list of draw buffers
-    GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-    glDrawBuffers(2, buffers);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-    {
-        juce::Logger::writeToLog("Scene framebuffer is not complete!");
-        return;
-    }
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    // blur FBO and texture
-    glGenFramebuffers(1, &blurFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, blurFBO);
-
-    glGenTextures(1, &blurTexture);
-    glBindTexture(GL_TEXTURE_2D, blurTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, getWidth(), getHeight(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, blurTexture, 0);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-    {
-        juce::Logger::writeToLog("Blur framebuffer is not complete!");
-        return;
-    }
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    //framebuffers and textures are created lazily by renderTargets on the first render()
 
     // init previous matrices
-    prevModelViewMatrix = juce::Matrix3D<float>(); // identity matrix
-    prevRedCubeModelViewMatrix = juce::Matrix3D<float>(); 
-    prevGreenCubeModelViewMatrix = juce::Matrix3D<float>(); 
+    viewMatrix = getViewMatrix();
+    prevViewMatrix = viewMatrix;
+    projectionChanged = true;
+
+    glReady = true;
 }
 
 void MainComponent::render()
@@ -443,6 +375,10 @@ void MainComponent::render()
 
     jassert(juce::OpenGLHelpers::isContextActive());
 
+    // initialise() bailed out, the timer will hand over to the software renderer
+    if (!glReady)
+        return;
+
   
     //cube roatation
    // rotation angles for a slow spin
@@ -459,188 +395,106 @@ void MainComponent::render()
 
     //transformations
 
-    // store the previous model-view matrices for each cube
-    prevRedCubeModelViewMatrix = redCubeModelViewMatrix;
-    prevGreenCubeModelViewMatrix = greenCubeModelViewMatrix;
-
-    // calculate the aspect ratio
-    float aspect = static_cast<float>(getWidth()) / getHeight();
+    // the projection only changes in resized()
+    if (projectionChanged.exchange(false))
+    {
+        const juce::SpinLock::ScopedLockType lock(projectionLock);
+        std::memcpy(sceneUniforms.projection, projectionMatrix.mat, sizeof(sceneUniforms.projection));
+    }
 
-    // create the projection matrix, perspective projection
-    float fov = 60.0f; // fov
-    float near = 1.0f;
-    float far = 100.0f;
-    float f = 1.0f / std::tan(juce::degreesToRadians(fov) / 2.0f);
+    // store the previous view matrix for the motion vectors
+    prevViewMatrix = viewMatrix;
+    viewMatrix = getViewMatrix();
 
-    float projectionMatrixValues[16] = {
-        f / aspect, 0.0f, 0.0f,                               0.0f,
-        0.0f,       f,      0.0f,                             0.0f,
-        0.0f,       0.0f,   (far + near) / (near - far),     -1.0f,
-        0.0f,       0.0f,   (2.0f * far * near) / (near - far), 0.0f
-    };
-    juce::Matrix3D<float> projectionMatrix(projectionMatrixValues);
+    std::memcpy(sceneUniforms.view, viewMatrix.mat, sizeof(sceneUniforms.view));
+    std::memcpy(sceneUniforms.prevView, prevViewMatrix.mat, sizeof(sceneUniforms.prevView));
 
-    //  rotation matrix
-    juce::Matrix3D<float> rotationMatrix = juce::Matrix3D<float>::rotation(
-        { juce::degreesToRadians(rotationX), juce::degreesToRadians(rotationY), 0.0f });
+    // size in physical pixels, targets are only reallocated when the view outgrows them.
+    // motion vectors only cost fill rate and VRAM when motion blur is actually on
+    const auto renderingScale = openGLContext.getRenderingScale();
+    const int targetWidth = juce::roundToInt(viewWidth.load() * renderingScale);
+    const int targetHeight = juce::roundToInt(viewHeight.load() * renderingScale);
 
-    //  translation matrix
-    juce::Matrix3D<float> translationMatrix(
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, -10.0f, 1.0f
-    );
+    if (!renderTargets.prepare(targetWidth, targetHeight, motionBlurEnabled.load()))
+    {
+        // the driver won't give us a usable framebuffer, hand over to the software renderer
+        glReady = false;
+        juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<MainComponent>(this)]
+            {
+                if (safeThis != nullptr)
+                    safeThis->switchToSoftwareRenderer();
+            });
+        return;
+    }
 
-    
+    const GLuint motionTexture = renderTargets.getMotionTexture();
 
-    float adjustedBaseSize = 1.0f + ((cubeSize - 1.0f) * 0.6f);
-    
-    float cubeSize1 = cubeSize;
+    sceneUniforms.params[0] = dampValue;
+    sceneUniforms.params[1] = static_cast<float>(motionTexture != 0 ? motionBlurSamples : 1);
+    sceneUniforms.params[2] = renderTargets.getUScale();
+    sceneUniforms.params[3] = renderTargets.getVScale();
 
-    // green cube scales based on widthValue
-    float minScale = 0.7f; 
-    float maxScale = 1.4f; 
-    float greenScaleFactor = minScale + (maxScale - minScale) * widthValue;
-    float whiteCubeSize = adjustedBaseSize * greenScaleFactor;
+    // red cube first so the translucent white one blends over it
+    const float scales[numCubeInstances] = { getRedCubeScale(), getWhiteCubeScale() };
+    const juce::Colour colours[numCubeInstances] = { cubeColor, juce::Colours::white.withAlpha(greenCubeAlpha) };
 
+    for (size_t i = 0; i < cubeInstances.size(); ++i)
+    {
+        auto& instance = cubeInstances[i];
+        instance.prevScale = instance.scale;
+        instance.scale = scales[i];
+        instance.colour[0] = colours[i].getFloatRed();
+        instance.colour[1] = colours[i].getFloatGreen();
+        instance.colour[2] = colours[i].getFloatBlue();
+        instance.colour[3] = colours[i].getFloatAlpha();
+    }
 
+    // one upload each for the uniforms and the instances, however many cubes there are
+    // rebinding the block each frame keeps it safe from JUCE's own component painting
+    glBindBufferBase(GL_UNIFORM_BUFFER, sceneUniformBinding, sceneUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(SceneUniforms), &sceneUniforms);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(cubeInstances), cubeInstances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     // render cubes to scene FBO 
 
     // bind and clear the scene framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
-    glViewport(0, 0, getWidth(), getHeight());
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f); // Set background to white
-
-
+    glBindFramebuffer(GL_FRAMEBUFFER, renderTargets.getFramebuffer());
+    glViewport(0, 0, targetWidth, targetHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     cubeShaderProgram->use();
 
-    // set uniforms
-    if (cubeProjectionMatrixUniform != nullptr)
-        cubeProjectionMatrixUniform->setMatrix4(projectionMatrix.mat, 1, false);
-
     // line width
     glLineWidth(5.7f);
 
-    //render red cube 
-    {
-        // set color 
-        if (cubeColorUniform != nullptr)
-            cubeColorUniform->set(cubeColor.getFloatRed(),
-                cubeColor.getFloatGreen(),
-                cubeColor.getFloatBlue());
-
-        // set alpha to  opaque
-        if (cubeAlphaUniform != nullptr)
-            cubeAlphaUniform->set(1.0f);
-
-        float adjustedRedCubeSize = adjustedBaseSize;
-        juce::Matrix3D<float> scalingMatrix1(
-            adjustedRedCubeSize, 0.0f, 0.0f, 0.0f,
-            0.0f, adjustedRedCubeSize, 0.0f, 0.0f,
-            0.0f, 0.0f, adjustedRedCubeSize, 0.0f,
-            0.0f, 0.0f, 0.0f, 1.0f
-        );
-        redCubeModelViewMatrix = translationMatrix * rotationMatrix * scalingMatrix1;
-
-        // set model-view matrices
-        if (cubeModelViewMatrixUniform != nullptr)
-            cubeModelViewMatrixUniform->setMatrix4(redCubeModelViewMatrix.mat, 1, false);
-        if (cubePrevModelViewMatrixUniform != nullptr)
-            cubePrevModelViewMatrixUniform->setMatrix4(prevRedCubeModelViewMatrix.mat, 1, false);
-
-        // bind VAO and draw red cube
-        glBindVertexArray(cubeVAO);
-        glDrawElements(GL_LINES, numIndices, GL_UNSIGNED_INT, 0);
-    }
-
-    // render green cube//
-    {
-        // color
-        if (cubeColorUniform != nullptr)
-            cubeColorUniform->set(1.0f, 1.0f, 1.0f);  // Black cube  // green color CHANGED TO WHITE
-
-        // set alpha to make the cube less visible
-        if (cubeAlphaUniform != nullptr)
-            cubeAlphaUniform->set(greenCubeAlpha);  // 
-
-        // scaling matrix for the green cube
-        juce::Matrix3D<float> scalingMatrix2(
-            whiteCubeSize, 0.0f, 0.0f, 0.0f,
-            0.0f, whiteCubeSize, 0.0f, 0.0f,
-            0.0f, 0.0f, whiteCubeSize, 0.0f,
-            0.0f, 0.0f, 0.0f, 1.0f
-        );
-        greenCubeModelViewMatrix = translationMatrix * rotationMatrix * scalingMatrix2;
-
-
-        // set model-view matrices
-        if (cubeModelViewMatrixUniform != nullptr)
-            cubeModelViewMatrixUniform->setMatrix4(greenCubeModelViewMatrix.mat, 1, false);
-        if (cubePrevModelViewMatrixUniform != nullptr)
-            cubePrevModelViewMatrixUniform->setMatrix4(prevGreenCubeModelViewMatrix.mat, 1, false);
-
-        // draw green cube
-        glDrawElements(GL_LINES, numIndices, GL_UNSIGNED_INT, 0);
-    }
-
-    // unbind VAO 
+    // all cubes in one draw
+    glBindVertexArray(cubeVAO);
+    glDrawElementsInstanced(GL_LINES, numIndices, GL_UNSIGNED_INT, 0, numCubeInstances);
     glBindVertexArray(0);
 
     // unbind the scene framebuffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    // motionblur
-    motionBlurShaderProgram->use();
-
-    // bind textures and set uniforms
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, colorTexture);
-    if (motionBlurColorTextureUniform != nullptr)
-        motionBlurColorTextureUniform->set(0);
-
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, motionTexture);
-    if (motionBlurMotionTextureUniform != nullptr)
-        motionBlurMotionTextureUniform->set(1);
-
-    // bind framebuffer and clear
-    glBindFramebuffer(GL_FRAMEBUFFER, blurFBO);
-    glViewport(0, 0, getWidth(), getHeight());
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f); // background to white
-
-
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    // draw the quad
-    glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    glBindVertexArray(0);
-
-    // unbind the framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    //basic blur 
-
-    
+    // single post pass: blur (and motion blur) the scene straight into the default framebuffer
     blurShaderProgram->use();
 
-    // bind the blurred texture from the motion blur pass
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, blurTexture);
-    if (blurTextureUniform != nullptr)
-        blurTextureUniform->set(0);
+    glBindTexture(GL_TEXTURE_2D, renderTargets.getColourTexture());
 
-    if (blurDampUniform != nullptr)
-        blurDampUniform->set(dampValue);
+    if (motionTexture != 0)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, motionTexture);
+        glActiveTexture(GL_TEXTURE0);
+    }
 
     // clear the default framebuffer
-    glViewport(0, 0, getWidth(), getHeight());
+    glViewport(0, 0, targetWidth, targetHeight);
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // background to white
 
 
@@ -655,7 +509,7 @@ void MainComponent::render()
 
 void MainComponent::shutdown()
 {
-    
+    glReady = false;
 
     // delete cube VAO and VBO
     if (cubeVAO != 0)
@@ -676,6 +530,18 @@ void MainComponent::shutdown()
         cubeEBO = 0;
     }
 
+    if (instanceVBO != 0)
+    {
+        glDeleteBuffers(1, &instanceVBO);
+        instanceVBO = 0;
+    }
+
+    if (sceneUBO != 0)
+    {
+        glDeleteBuffers(1, &sceneUBO);
+        sceneUBO = 0;
+    }
+
     // delete quad VAO and VBO
     if (quadVAO != 0)
     {
@@ -690,74 +556,48 @@ void MainComponent::shutdown()
     }
 
     // delete textures and framebuffers
-    if (colorTexture != 0)
-    {
-        glDeleteTextures(1, &colorTexture);
-        colorTexture = 0;
-    }
-
-    if (motionTexture != 0)
-    {
-        glDeleteTextures(1, &motionTexture);
-        motionTexture = 0;
-    }
-
-    if (sceneFBO != 0)
-    {
-        glDeleteFramebuffers(1, &sceneFBO);
-        sceneFBO = 0;
-    }
-
-    if (blurTexture != 0)
-    {
-        glDeleteTextures(1, &blurTexture);
-        blurTexture = 0;
-    }
-
-    if (blurFBO != 0)
-    {
-        glDeleteFramebuffers(1, &blurFBO);
-        blurFBO = 0;
-    }
+    renderTargets.release();
 
     // reset
     cubeShaderProgram.reset();
-    motionBlurShaderProgram.reset();
     blurShaderProgram.reset();
 }
 
 void MainComponent::paint(juce::Graphics& g)
 {
-    // handled in render()
+    // handled in render() unless GL is unavailable
+    if (!usingSoftwareRenderer)
+        return;
+
+    const std::array<CubeSoftwareRenderer::Cube, 2> cubes{ {
+        { getRedCubeScale(), cubeColor, 1.0f },
+        { getWhiteCubeScale(), juce::Colours::white, greenCubeAlpha }
+    } };
+
+    const float pixelScale = static_cast<float>(g.getInternalContext().getPhysicalPixelScaleFactor());
+
+    softwareRenderer.render(g, getLocalBounds(), pixelScale,
+        projectionMatrix, getViewMatrix(), cubes, dampValue);
 }
 
 void MainComponent::resized()
 {
-    // handle window resizing
-    // update textures and framebuffers to match new size
-
-    if (colorTexture != 0)
+    // the projection only depends on the aspect ratio, so it's rebuilt here instead of every frame
     {
-        glBindTexture(GL_TEXTURE_2D, colorTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, getWidth(), getHeight(),
-            0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        const juce::SpinLock::ScopedLockType lock(projectionLock);
+        projectionMatrix = createProjectionMatrix(static_cast<float>(getWidth()) / juce::jmax(1, getHeight()));
     }
+    projectionChanged = true;
 
-    if (motionTexture != 0)
-    {
-        glBindTexture(GL_TEXTURE_2D, motionTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, getWidth(), getHeight(),
-            0, GL_RG, GL_FLOAT, nullptr);
-    }
-
-    if (blurTexture != 0)
-    {
-        glBindTexture(GL_TEXTURE_2D, blurTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, getWidth(), getHeight(),
-            0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    }
+    // render targets follow on the GL thread, no GL calls from the message thread
+    viewWidth = getWidth();
+    viewHeight = getHeight();
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+void MainComponent::setMotionBlurEnabled(bool shouldBeEnabled)
+{
+    // picked up by render() on the GL thread
+    motionBlurEnabled = shouldBeEnabled;
 }
 
 void MainComponent::mouseMove(const juce::MouseEvent& event)
@@ -793,6 +633,108 @@ void MainComponent::mouseUp(const juce::MouseEvent& event)
     isDragging = false;
 }
 
+void MainComponent::timerCallback()
+{
+    const double nowMs = juce::Time::getMillisecondCounterHiRes();
+    const double elapsedMs = nowMs - lastTimerMs;
+    lastTimerMs = nowMs;
+
+    if (usingSoftwareRenderer)
+    {
+        // same spin speed as the GL path, which advances once per ~60 Hz frame
+        const float frames = static_cast<float>(elapsedMs / (1000.0 / 60.0));
+        rotationX = std::fmod(rotationX + 0.1f * frames, 360.0f);
+        rotationY = std::fmod(rotationY + 0.2f * frames, 360.0f);
+        repaint();
+        return;
+    }
+
+    // forced off, or the shaders/framebuffers failed to build
+    if (openglDisabled || glInitialiseFailed)
+    {
+        switchToSoftwareRenderer();
+        return;
+    }
+
+    if (glReady)
+    {
+        // GL is running, nothing left to watch
+        stopTimer();
+        return;
+    }
+
+    // no context at all, only count time while we're actually on screen
+    if (isShowing())
+        glWaitMs += elapsedMs;
+
+    if (glWaitMs > glStartupTimeoutMs)
+        switchToSoftwareRenderer();
+}
+
+void MainComponent::switchToSoftwareRenderer()
+{
+    juce::Logger::writeToLog("OpenGL unavailable, using software cube renderer");
+
+    openglDisabled = true;
+    usingSoftwareRenderer = true;
+
+    // detaching calls shutdown() on the GL thread and hands painting back to paint()
+    openGLContext.detach();
+    softwareRenderer.reset();
+
+    if (!isTimerRunning())
+        startTimerHz(30);
+
+    repaint();
+}
+
+juce::Matrix3D<float> MainComponent::getViewMatrix() const
+{
+    //  rotation matrix
+    juce::Matrix3D<float> rotationMatrix = juce::Matrix3D<float>::rotation(
+        { juce::degreesToRadians(rotationX), juce::degreesToRadians(rotationY), 0.0f });
+
+    //  translation matrix
+    juce::Matrix3D<float> translationMatrix(
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, -10.0f, 1.0f
+    );
+
+    return translationMatrix * rotationMatrix;
+}
+
+juce::Matrix3D<float> MainComponent::createProjectionMatrix(float aspect)
+{
+    float fov = 60.0f; // fov
+    float near = 1.0f;
+    float far = 100.0f;
+    float f = 1.0f / std::tan(juce::degreesToRadians(fov) / 2.0f);
+
+    float projectionMatrixValues[16] = {
+        f / aspect, 0.0f, 0.0f,                               0.0f,
+        0.0f,       f,      0.0f,                             0.0f,
+        0.0f,       0.0f,   (far + near) / (near - far),     -1.0f,
+        0.0f,       0.0f,   (2.0f * far * near) / (near - far), 0.0f
+    };
+    return juce::Matrix3D<float>(projectionMatrixValues);
+}
+
+float MainComponent::getRedCubeScale() const
+{
+    return 1.0f + ((cubeSize - 1.0f) * 0.6f);
+}
+
+float MainComponent::getWhiteCubeScale() const
+{
+    // white cube scales based on widthValue
+    float minScale = 0.7f; 
+    float maxScale = 1.4f; 
+    float scaleFactor = minScale + (maxScale - minScale) * widthValue;
+    return getRedCubeScale() * scaleFactor;
+}
+
 juce::Colour MainComponent::interpolateColor(const juce::Colour& startColor,
     const juce::Colour& endColor,
     float ratio)
@@ -3,8 +3,11 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "CubeSoftwareRenderer.h"
+#include "RenderTargetPool.h"
 
-class MainComponent : public juce::OpenGLAppComponent
+class MainComponent : public juce::OpenGLAppComponent,
+    private juce::Timer
 {
 public:
     MainComponent();
@@ -15,6 +18,7 @@ public:
     void setDampValue(float newDamp);
     void setWidthValue(float newWidth);
     void setGreenCubeAlpha(float newAlpha); // Setter for green cube alpha
+    void setMotionBlurEnabled(bool shouldBeEnabled);
 
     void initialise() override;
     void shutdown() override;
@@ -28,11 +32,27 @@ public:
     void mouseDrag(const juce::MouseEvent& event) override;
     void mouseUp(const juce::MouseEvent& event) override;
 
-    bool openglDisabled = false;
+    bool openglDisabled = false;     // set to force the software renderer
 
 
 private:
-    
+    void timerCallback() override;
+    void switchToSoftwareRenderer();
+
+    juce::Matrix3D<float> getViewMatrix() const;
+    static juce::Matrix3D<float> createProjectionMatrix(float aspect);
+    float getRedCubeScale() const;
+    float getWhiteCubeScale() const;
+
+    // software fallback, used when the GL context never comes up or the shaders fail
+    CubeSoftwareRenderer softwareRenderer;
+    bool usingSoftwareRenderer = false;
+    std::atomic<bool> glInitialiseFailed{ false };
+    std::atomic<bool> glReady{ false };
+    double glWaitMs = 0.0;
+    double lastTimerMs = 0.0;
+    static constexpr double glStartupTimeoutMs = 2000.0;
+
     float rotationX = 0.0f;
     float rotationY = 0.0f;
     float lastMouseX = 0.0f;
@@ -47,50 +67,60 @@ private:
 
     // shader programs
     std::unique_ptr<juce::OpenGLShaderProgram> cubeShaderProgram;        // rendering the cube
-    std::unique_ptr<juce::OpenGLShaderProgram> motionBlurShaderProgram;  //  applying motion blur
-    std::unique_ptr<juce::OpenGLShaderProgram> blurShaderProgram;        //  applying basic blur
+    std::unique_ptr<juce::OpenGLShaderProgram> blurShaderProgram;        //  blur + optional motion blur
 
-    // cube shader uniforms and attributes
+    // cube shader attributes
     std::unique_ptr<juce::OpenGLShaderProgram::Attribute> cubePositionAttribute;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> cubeProjectionMatrixUniform;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> cubeModelViewMatrixUniform;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> cubePrevModelViewMatrixUniform;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> cubeColorUniform;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> cubeAlphaUniform; // alpha uniform for transparency
-
-    // motion blur shader uniforms and attributes
-    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> quadPositionAttribute;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> motionBlurColorTextureUniform;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> motionBlurMotionTextureUniform;
-
-    // blur shader uniforms and attributes
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> blurTextureUniform;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> blurDampUniform;
-    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> blurDirectionUniform;
+
+    // per-instance cube data (attribute locations 1 and 2)
+    struct CubeInstance
+    {
+        float scale = 1.0f;
+        float prevScale = 1.0f;
+        float colour[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    };
+
+    static constexpr int numCubeInstances = 2;
+    std::array<CubeInstance, numCubeInstances> cubeInstances;
+
+    // SceneBlock, std140 layout, uploaded once per frame and shared by both programs
+    struct SceneUniforms
+    {
+        float projection[16];
+        float view[16];
+        float prevView[16];
+        float params[4];    // x = damp, y = motion blur samples
+    };
+
+    SceneUniforms sceneUniforms{};
+    static constexpr GLuint sceneUniformBinding = 0;
+
+    // motion blur is off by default, the motion vector target only exists while it's on
+    std::atomic<bool> motionBlurEnabled{ false };
+    static constexpr int motionBlurSamples = 4;
 
     GLuint cubeVAO = 0;
     GLuint cubeVBO = 0;
     GLuint cubeEBO = 0;
+    GLuint instanceVBO = 0;
+    GLuint sceneUBO = 0;
     GLuint numIndices = 0;
 
-    // framebuffers and textures
-    GLuint sceneFBO = 0;
-    GLuint colorTexture = 0;
-    GLuint motionTexture = 0;
-    GLuint blurFBO = 0;
-    GLuint blurTexture = 0;
+    // framebuffers and textures, GL thread only
+    RenderTargetPool renderTargets;
+    std::atomic<int> viewWidth{ 0 };            // logical size, written in resized()
+    std::atomic<int> viewHeight{ 0 };
 
     // quad for rendering
     GLuint quadVAO = 0;
     GLuint quadVBO = 0;
 
     // transformation matrices
-    juce::Matrix3D<float> modelViewMatrix;                // current model-view matrix
-    juce::Matrix3D<float> prevModelViewMatrix;            // previous model-view matrix
-    juce::Matrix3D<float> redCubeModelViewMatrix;         //model-view matrix for red cube
-    juce::Matrix3D<float> greenCubeModelViewMatrix;       //model-view matrix for green cube
-    juce::Matrix3D<float> prevRedCubeModelViewMatrix;     // previous model-view matrix for red cube
-    juce::Matrix3D<float> prevGreenCubeModelViewMatrix;   //previous model-view matrix for green cube
+    juce::Matrix3D<float> viewMatrix;                     // current view matrix (GL thread)
+    juce::Matrix3D<float> prevViewMatrix;                 // previous view matrix (GL thread)
+    juce::Matrix3D<float> projectionMatrix;               // rebuilt in resized() only
+    juce::SpinLock projectionLock;
+    std::atomic<bool> projectionChanged{ true };
 
     juce::Colour interpolateColor(const juce::Colour& startColor,
         const juce::Colour& endColor,
@@ -1,12 +1,29 @@
 #pragma once
 
-class OverlayFilter
+// overlays get every channel of a block at once and keep their state per channel, so a
+// filter with memory hears each channel as its own continuous signal
+template <typename SampleType>
+class OverlayFilterT
 {
 public:
-    virtual ~OverlayFilter() = default;
+    // mono or stereo, see PluginProcessor::isBusesLayoutSupported
+    static constexpr int maxChannels = 2;
 
-    // process a single audio sample.
-    virtual float processSample(float inputSample) = 0;
+    virtual ~OverlayFilterT() = default;
+
+    // process a single audio sample of one channel.
+    virtual SampleType processSample(int channel, SampleType inputSample) = 0;
+
+    // process every channel of a block in place, filters with a block kernel override this.
+    virtual void processBlock(SampleType* const* channels, int numChannels, int numSamples)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                channels[channel][i] = processSample(channel, channels[channel][i]);
+    }
+
+    // forget the per-channel state.
+    virtual void reset() {}
 
     // parameter setters.
     virtual void setMix(float newMix) { mix = newMix; }
@@ -15,4 +32,6 @@ public:
 protected:
     float mix{ 1.0f };   
     float drive{ 1.0f }; 
-};
\ No newline at end of file
+};
+
+using OverlayFilter = OverlayFilterT<float>;
@@ -2,21 +2,35 @@
 #include "OverlayFilter.h"
 #include <memory>
 
-class OverlayFilterChain
+template <typename SampleType>
+class OverlayFilterChainT
 {
 public:
     //set the active overlay filter 
-    void setActiveFilter(std::unique_ptr<OverlayFilter> newFilter)
+    void setActiveFilter(std::unique_ptr<OverlayFilterT<SampleType>> newFilter)
     {
         activeFilter = std::move(newFilter);
     }
 
-    // rocess a sample through the active overlay filter.
-    float processSample(float inputSample)
+    // rocess a sample of one channel through the active overlay filter.
+    SampleType processSample(int channel, SampleType inputSample)
     {
         if (!activeFilter)
             return inputSample;
-        return activeFilter->processSample(inputSample);
+        return activeFilter->processSample(channel, inputSample);
+    }
+
+    // process every channel of a block in place, one virtual call for the lot.
+    void processBlock(SampleType* const* channels, int numChannels, int numSamples)
+    {
+        if (activeFilter)
+            activeFilter->processBlock(channels, numChannels, numSamples);
+    }
+
+    void reset()
+    {
+        if (activeFilter)
+            activeFilter->reset();
     }
 
     // forward parameter settings to the active filter.
@@ -33,5 +47,7 @@ public:
     }
 
 private:
-    std::unique_ptr<OverlayFilter> activeFilter;
-};
\ No newline at end of file
+    std::unique_ptr<OverlayFilterT<SampleType>> activeFilter;
+};
+
+using OverlayFilterChain = OverlayFilterChainT<float>;
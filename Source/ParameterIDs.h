@@ -7,6 +7,15 @@ namespace ParameterIDs
     inline constexpr auto damp{ "DECAY" };
     inline constexpr auto width{ "WIDTH" };
     inline constexpr auto mix{ "MIX" };
+    inline constexpr auto overlayBlend{ "OVERLAY_BLEND" };
+    inline constexpr auto overlayOn{ "OVERLAY_ON" };
+    inline constexpr auto preDelay{ "PREDELAY" };
+    inline constexpr auto preDelaySync{ "PREDELAY_SYNC" };
+    inline constexpr auto lowDecay{ "LOW_DECAY" };
+    inline constexpr auto midDecay{ "MID_DECAY" };
+    inline constexpr auto highDecay{ "HIGH_DECAY" };
+    inline constexpr auto duck{ "DUCK" };
+    inline constexpr auto duckRelease{ "DUCK_RELEASE" };
     inline constexpr auto freeze{ "freeze" }; // unchanged for now 
 }
 
@@ -0,0 +1,299 @@
+#include "PerformanceMonitor.h"
+#include "SimdKernels.h"
+
+#if ANGELS_PERF_INSTRUMENTATION
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // allocations are only counted while the audio thread is inside processBlock
+    thread_local bool isInAudioCallback = false;
+    thread_local juce::uint64 audioThreadAllocations = 0;
+}
+
+#if ANGELS_PERF_COUNT_ALLOCATIONS
+
+// counting operator new and delete, every form so each allocation is counted and freed by
+// its match. a replaced operator new is the whole process's, on linux that takes in a host
+// that loads the plugin, which is why it's opt in. best left to the standalone app
+
+namespace
+{
+    void* allocate(std::size_t size) noexcept
+    {
+        PerformanceMonitor::noteAllocation();
+        return std::malloc(size > 0 ? size : 1);
+    }
+
+    void* allocate(std::size_t size, std::align_val_t alignment) noexcept
+    {
+        PerformanceMonitor::noteAllocation();
+        const auto bytes = size > 0 ? size : 1;
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc(bytes, static_cast<std::size_t>(alignment));
+       #else
+        void* ptr = nullptr;
+        return posix_memalign(&ptr, juce::jmax(static_cast<std::size_t>(alignment), sizeof(void*)), bytes) == 0 ? ptr : nullptr;
+       #endif
+    }
+
+    void* allocateOrThrow(void* ptr)
+    {
+        if (ptr == nullptr)
+            throw std::bad_alloc();
+
+        return ptr;
+    }
+
+    void release(void* ptr) noexcept { std::free(ptr); }
+
+    void releaseAligned(void* ptr) noexcept
+    {
+       #if JUCE_WINDOWS
+        _aligned_free(ptr);
+       #else
+        std::free(ptr);
+       #endif
+    }
+}
+
+void* operator new(std::size_t size) { return allocateOrThrow(allocate(size)); }
+void* operator new[](std::size_t size) { return allocateOrThrow(allocate(size)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateOrThrow(allocate(size, alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateOrThrow(allocate(size, alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, alignment); }
+
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { releaseAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { releaseAligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { releaseAligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { releaseAligned(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(ptr); }
+
+#endif
+
+//==============================================================================
+PerformanceMonitor::ScopedCallback::ScopedCallback(PerformanceMonitor& m, int samples) noexcept
+    : monitor(m),
+    numSamples(samples),
+    startTicks(juce::Time::getHighResolutionTicks()),
+    startAllocations(audioThreadAllocations)
+{
+    isInAudioCallback = true;
+}
+
+PerformanceMonitor::ScopedCallback::~ScopedCallback() noexcept
+{
+    isInAudioCallback = false;
+    monitor.recordCallback(numSamples, juce::Time::getHighResolutionTicks() - startTicks,
+        audioThreadAllocations - startAllocations);
+}
+
+PerformanceMonitor::ScopedStage::ScopedStage(PerformanceMonitor* m, Stage s) noexcept
+    : monitor(m),
+    stage(s),
+    startTicks(m != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+{
+}
+
+PerformanceMonitor::ScopedStage::~ScopedStage() noexcept
+{
+    if (monitor != nullptr)
+        monitor->recordStage(stage, juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+//==============================================================================
+void PerformanceMonitor::prepare(double newSampleRate)
+{
+    sampleRate.store(newSampleRate, std::memory_order_relaxed);
+    reset();
+}
+
+void PerformanceMonitor::reset()
+{
+    for (auto& t : stageTicks) t.store(0, std::memory_order_relaxed);
+    for (auto& t : stageMaxTicks) t.store(0, std::memory_order_relaxed);
+    for (auto& h : histogram) h.store(0, std::memory_order_relaxed);
+
+    callbackTicks.store(0, std::memory_order_relaxed);
+    callbackMaxTicks.store(0, std::memory_order_relaxed);
+    callbacks.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+    allocations.store(0, std::memory_order_relaxed);
+
+    previousSnapshot = {};
+}
+
+void PerformanceMonitor::noteAllocation() noexcept
+{
+    if (isInAudioCallback)
+        ++audioThreadAllocations;
+}
+
+void PerformanceMonitor::recordStage(Stage stage, juce::int64 ticks) noexcept
+{
+    const auto index = static_cast<size_t>(stage);
+    stageTicks[index].store(stageTicks[index].load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    storeMax(stageMaxTicks[index], ticks);
+}
+
+void PerformanceMonitor::recordCallback(int numSamples, juce::int64 ticks, juce::uint64 newAllocations) noexcept
+{
+    const double deadlineTicks = ticksPerSecond * numSamples / sampleRate.load(std::memory_order_relaxed);
+    const double ratio = deadlineTicks > 0.0 ? static_cast<double>(ticks) / deadlineTicks : 0.0;
+    const int bucket = juce::jlimit(0, numHistogramBuckets - 1, static_cast<int>(ratio * 10.0));
+
+    increment(histogram[static_cast<size_t>(bucket)]);
+
+    if (ratio >= 1.0)
+        increment(overruns);
+
+    if (newAllocations > 0)
+        increment(allocations, newAllocations);
+
+    callbackTicks.store(callbackTicks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    storeMax(callbackMaxTicks, ticks);
+    lastDeadlineTicks.store(static_cast<juce::int64>(deadlineTicks), std::memory_order_relaxed);
+
+    // published last, so a reader that sees the count also sees the times that go with it
+    callbacks.store(callbacks.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void PerformanceMonitor::storeMax(std::atomic<juce::int64>& target, juce::int64 value) noexcept
+{
+    // single writer, no compare-exchange needed
+    if (value > target.load(std::memory_order_relaxed))
+        target.store(value, std::memory_order_relaxed);
+}
+
+void PerformanceMonitor::increment(std::atomic<juce::uint64>& counter, juce::uint64 amount) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+//==============================================================================
+PerformanceMonitor::Snapshot PerformanceMonitor::getSnapshot() const
+{
+    Snapshot s;
+    s.callbacks = callbacks.load(std::memory_order_acquire);
+    s.overruns = overruns.load(std::memory_order_relaxed);
+    s.allocations = allocations.load(std::memory_order_relaxed);
+
+    const double microsPerTick = 1.0e6 / ticksPerSecond;
+    const double perCallback = s.callbacks > 0 ? microsPerTick / static_cast<double>(s.callbacks) : 0.0;
+
+    s.deadlineMicros = static_cast<double>(lastDeadlineTicks.load(std::memory_order_relaxed)) * microsPerTick;
+    s.callbackAverageMicros = static_cast<double>(callbackTicks.load(std::memory_order_relaxed)) * perCallback;
+    s.callbackMaxMicros = static_cast<double>(callbackMaxTicks.load(std::memory_order_relaxed)) * microsPerTick;
+
+    for (size_t i = 0; i < static_cast<size_t>(numStages); ++i)
+    {
+        s.stageAverageMicros[i] = static_cast<double>(stageTicks[i].load(std::memory_order_relaxed)) * perCallback;
+        s.stageMaxMicros[i] = static_cast<double>(stageMaxTicks[i].load(std::memory_order_relaxed)) * microsPerTick;
+    }
+
+    for (size_t i = 0; i < histogram.size(); ++i)
+        s.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+
+    return s;
+}
+
+PerformanceMonitor::Snapshot PerformanceMonitor::getSnapshotSinceLastCall()
+{
+    const auto total = getSnapshot();
+    auto recent = total;
+
+    recent.callbacks = total.callbacks - previousSnapshot.callbacks;
+    recent.overruns = total.overruns - previousSnapshot.overruns;
+    recent.allocations = total.allocations - previousSnapshot.allocations;
+
+    for (size_t i = 0; i < recent.histogram.size(); ++i)
+        recent.histogram[i] = total.histogram[i] - previousSnapshot.histogram[i];
+
+    // averages over the window from the running totals
+    const auto weight = [&](double totalAverage, double previousAverage)
+    {
+        return recent.callbacks > 0
+            ? (totalAverage * total.callbacks - previousAverage * previousSnapshot.callbacks) / recent.callbacks
+            : 0.0;
+    };
+
+    recent.callbackAverageMicros = weight(total.callbackAverageMicros, previousSnapshot.callbackAverageMicros);
+
+    for (size_t i = 0; i < recent.stageAverageMicros.size(); ++i)
+        recent.stageAverageMicros[i] = weight(total.stageAverageMicros[i], previousSnapshot.stageAverageMicros[i]);
+
+    previousSnapshot = total;
+    return recent;
+}
+
+bool PerformanceMonitor::writeReport(const juce::File& file) const
+{
+    juce::String report;
+    report << "Angels processBlock report, " << juce::Time::getCurrentTime().toString(true, true) << juce::newLine
+           << "sample rate: " << sampleRate.load(std::memory_order_relaxed) << " Hz" << juce::newLine
+           << "kernels: " << SimdKernels::getIsaName(SimdKernels::getActiveIsa()) << juce::newLine
+           << juce::newLine
+           << getSnapshot().toString();
+
+    return file.replaceWithText(report);
+}
+
+juce::String PerformanceMonitor::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::parameters: return "parameters";
+        case Stage::reverb:     return "reverb";
+        case Stage::overlay:    return "overlay";
+        case Stage::output:     return "mix + limit";
+        case Stage::numStages:  break;
+    }
+
+    return {};
+}
+
+juce::String PerformanceMonitor::Snapshot::toString() const
+{
+    juce::String text;
+    text << "callbacks: " << juce::String(static_cast<juce::int64>(callbacks))
+         << "  overruns: " << juce::String(static_cast<juce::int64>(overruns))
+         << "  allocations: " << (ANGELS_PERF_COUNT_ALLOCATIONS ? juce::String(static_cast<juce::int64>(allocations)) : juce::String("not counted"))
+         << juce::newLine
+         << "callback: avg " << juce::String(callbackAverageMicros, 1) << " us, max "
+         << juce::String(callbackMaxMicros, 1) << " us, deadline " << juce::String(deadlineMicros, 1) << " us" << juce::newLine;
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        text << "  " << getStageName(static_cast<Stage>(i)).paddedRight(' ', 12)
+             << "avg " << juce::String(stageAverageMicros[static_cast<size_t>(i)], 2) << " us, max "
+             << juce::String(stageMaxMicros[static_cast<size_t>(i)], 2) << " us" << juce::newLine;
+    }
+
+    text << "load vs deadline:" << juce::newLine;
+
+    for (int i = 0; i < numHistogramBuckets; ++i)
+    {
+        const auto label = i < numHistogramBuckets - 1
+            ? juce::String(i * 10) + "-" + juce::String(i * 10 + 10) + "%"
+            : juce::String(">=100%");
+
+        text << "  " << label.paddedRight(' ', 9) << juce::String(static_cast<juce::int64>(histogram[static_cast<size_t>(i)])) << juce::newLine;
+    }
+
+    return text;
+}
+
+#endif
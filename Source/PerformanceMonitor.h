@@ -0,0 +1,143 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// build-time switch for the audio-thread instrumentation. on by default in debug builds,
+// define ANGELS_PERF_INSTRUMENTATION=1 in the project to keep it in a release build.
+#ifndef ANGELS_PERF_INSTRUMENTATION
+ #if JUCE_DEBUG
+  #define ANGELS_PERF_INSTRUMENTATION 1
+ #else
+  #define ANGELS_PERF_INSTRUMENTATION 0
+ #endif
+#endif
+
+// counting the audio thread's allocations replaces the global operator new, which a plugin
+// shouldn't do behind a host's back, so it's its own switch and off unless asked for. define ANGELS_PERF_COUNT_ALLOCATIONS=1 as
+// well as the above to get it, otherwise the count stays at zero
+#ifndef ANGELS_PERF_COUNT_ALLOCATIONS
+ #define ANGELS_PERF_COUNT_ALLOCATIONS 0
+#endif
+
+#if ANGELS_PERF_INSTRUMENTATION
+
+// per-stage timing, callback-vs-deadline histogram, overrun and allocation counters for
+// PluginProcessor::processBlock. the audio thread is the only writer and only does relaxed
+// atomic loads/stores; any other thread can take a snapshot at any time.
+class PerformanceMonitor
+{
+public:
+    enum class Stage
+    {
+        parameters,
+        reverb,
+        overlay,
+        output,         // dry/wet mix and output gain in one fused pass, then the true-peak limiter
+        numStages
+    };
+
+    static constexpr int numStages = static_cast<int>(Stage::numStages);
+
+    // callback duration as a fraction of the buffer deadline, in 10% steps; the last bucket is >= 100%
+    static constexpr int numHistogramBuckets = 11;
+
+    struct Snapshot
+    {
+        juce::uint64 callbacks = 0;
+        juce::uint64 overruns = 0;              // callbacks that took longer than the buffer lasts
+        juce::uint64 allocations = 0;           // heap allocations made on the audio thread, see ANGELS_PERF_COUNT_ALLOCATIONS
+        double deadlineMicros = 0.0;            // of the last callback
+        double callbackAverageMicros = 0.0;
+        double callbackMaxMicros = 0.0;
+        std::array<double, numStages> stageAverageMicros{};
+        std::array<double, numStages> stageMaxMicros{};
+        std::array<juce::uint64, numHistogramBuckets> histogram{};
+
+        juce::String toString() const;
+    };
+
+    // times one processBlock call
+    class ScopedCallback
+    {
+    public:
+        ScopedCallback(PerformanceMonitor& m, int numSamples) noexcept;
+        ~ScopedCallback() noexcept;
+
+    private:
+        PerformanceMonitor& monitor;
+        const int numSamples;
+        const juce::int64 startTicks;
+        const juce::uint64 startAllocations;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedCallback)
+    };
+
+    // times one stage inside a callback, a null monitor makes it a no-op
+    class ScopedStage
+    {
+    public:
+        ScopedStage(PerformanceMonitor* m, Stage s) noexcept;
+        ~ScopedStage() noexcept;
+
+    private:
+        PerformanceMonitor* monitor;
+        const Stage stage;
+        const juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+
+    void prepare(double newSampleRate);
+    void reset();
+
+    Snapshot getSnapshot() const;
+
+    // counts accumulated since the previous call, for the "recent" view in the overlay
+    Snapshot getSnapshotSinceLastCall();
+
+    bool writeReport(const juce::File& file) const;
+
+    static juce::String getStageName(Stage stage);
+
+    // called from the replaced operator new, when allocations are counted
+    static void noteAllocation() noexcept;
+
+private:
+    void recordStage(Stage stage, juce::int64 ticks) noexcept;
+    void recordCallback(int numSamples, juce::int64 ticks, juce::uint64 allocations) noexcept;
+
+    static void storeMax(std::atomic<juce::int64>& target, juce::int64 value) noexcept;
+    static void increment(std::atomic<juce::uint64>& counter, juce::uint64 amount = 1) noexcept;
+
+    std::atomic<double> sampleRate{ 44100.0 };
+    const double ticksPerSecond = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+
+    std::array<std::atomic<juce::int64>, numStages> stageTicks{};
+    std::array<std::atomic<juce::int64>, numStages> stageMaxTicks{};
+    std::array<std::atomic<juce::uint64>, numHistogramBuckets> histogram{};
+
+    std::atomic<juce::int64> callbackTicks{ 0 };
+    std::atomic<juce::int64> callbackMaxTicks{ 0 };
+    std::atomic<juce::int64> lastDeadlineTicks{ 0 };
+    std::atomic<juce::uint64> callbacks{ 0 };
+    std::atomic<juce::uint64> overruns{ 0 };
+    std::atomic<juce::uint64> allocations{ 0 };
+
+    Snapshot previousSnapshot;      // reader side only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceMonitor)
+};
+
+ #define ANGELS_PERF_CALLBACK(monitor, numSamples) \
+    const PerformanceMonitor::ScopedCallback perfCallbackScope((monitor), (numSamples))
+ #define ANGELS_PERF_STAGE(monitorPtr, stage) \
+    const PerformanceMonitor::ScopedStage JUCE_JOIN_MACRO(perfStageScope, __LINE__)((monitorPtr), PerformanceMonitor::Stage::stage)
+
+#else
+
+ #define ANGELS_PERF_CALLBACK(monitor, numSamples)
+ #define ANGELS_PERF_STAGE(monitorPtr, stage)
+
+#endif
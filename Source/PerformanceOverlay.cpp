@@ -0,0 +1,43 @@
+#include "PerformanceOverlay.h"
+
+#if ANGELS_PERF_INSTRUMENTATION
+
+PerformanceOverlay::PerformanceOverlay(PerformanceMonitor& monitorToShow)
+    : monitor(monitorToShow)
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+void PerformanceOverlay::visibilityChanged()
+{
+    // only poll while someone is looking
+    if (isVisible())
+        startTimerHz(4);
+    else
+        stopTimer();
+}
+
+void PerformanceOverlay::timerCallback()
+{
+    recent = monitor.getSnapshotSinceLastCall();
+    total = monitor.getSnapshot();
+    repaint();
+}
+
+void PerformanceOverlay::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black.withAlpha(0.75f));
+
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+
+    juce::String text;
+    text << "last 250 ms" << juce::newLine << recent.toString() << juce::newLine
+         << "since prepare: overruns " << juce::String(static_cast<juce::int64>(total.overruns))
+         << ", allocations " << (ANGELS_PERF_COUNT_ALLOCATIONS ? juce::String(static_cast<juce::int64>(total.allocations)) : juce::String("not counted"))
+         << ", max " << juce::String(total.callbackMaxMicros, 1) << " us";
+
+    g.drawMultiLineText(text, 8, 16, getWidth() - 16);
+}
+
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PerformanceMonitor.h"
+
+#if ANGELS_PERF_INSTRUMENTATION
+
+// text overlay with the latest processBlock timings, refreshed a few times a second.
+// toggled from PluginEditor, only exists in instrumented builds
+class PerformanceOverlay : public juce::Component,
+    private juce::Timer
+{
+public:
+    explicit PerformanceOverlay(PerformanceMonitor& monitorToShow);
+
+    void paint(juce::Graphics& g) override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+
+    PerformanceMonitor& monitor;
+    PerformanceMonitor::Snapshot recent;
+    PerformanceMonitor::Snapshot total;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceOverlay)
+};
+
+#endif
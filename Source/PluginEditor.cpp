@@ -6,17 +6,26 @@ PluginEditor::PluginEditor(PluginProcessor& p, juce::UndoManager& um)
     : AudioProcessorEditor(&p),
     processor(p),
     undoManager(um),
+    backgroundLayer(),
     editorContent(p, um, *this),
     openGLComponent(),
     displayOverlay()
+#if ANGELS_PERF_INSTRUMENTATION
+    , performanceOverlay(p.getPerformanceMonitor())
+#endif
 {
     setSize(350, 500);
 
 
     // components in the  layering order
+    addAndMakeVisible(backgroundLayer);
     addAndMakeVisible(openGLComponent);
     addAndMakeVisible(editorContent);
 
+#if ANGELS_PERF_INSTRUMENTATION
+    addChildComponent(performanceOverlay);
+#endif
+
 
     //setSize(defaultWidth, defaultHeight); // Set the initial size
 }
@@ -24,31 +33,8 @@ PluginEditor::PluginEditor(PluginProcessor& p, juce::UndoManager& um)
 
 void PluginEditor::paint(juce::Graphics& g)
 {
-
-    auto backgroundImage = juce::ImageCache::getFromMemory(BinaryData::BACKGROUND_png, BinaryData::BACKGROUND_pngSize);
-
-    // check if the image loaded
-    if (backgroundImage.isValid())
-    {
-        // draw the image to fill the plugin's background 
-        g.drawImage(backgroundImage, getLocalBounds().toFloat());
-    }
-    else
-    {
-        // fallback to a solid if  image fails 
-        g.fillAll(juce::Colours::black);
-    }
-
-
-
-
-    auto area = getLocalBounds().toFloat();
-    area.removeFromTop(30);
-
-    // make the rounded rectangle smaller 
-    auto cutoutBounds = area.removeFromTop(150).withTrimmedLeft(75).withTrimmedRight(75);
-
-   
+    // the background is drawn by backgroundLayer, which caches itself as an opaque image
+    juce::ignoreUnused(g);
 }
 
 void PluginEditor::resized()
@@ -56,6 +42,8 @@ void PluginEditor::resized()
     //setSize(300, 600);
     auto area = getLocalBounds();
 
+    backgroundLayer.setBounds(area);
+
     // 10px padding at the top
     area.removeFromTop(30);
 
@@ -66,6 +54,10 @@ void PluginEditor::resized()
     // remaining space for sliders and controls
     editorContent.setBounds(area);
 
+#if ANGELS_PERF_INSTRUMENTATION
+    performanceOverlay.setBounds(getLocalBounds().reduced(10));
+#endif
+
 
 
 }
@@ -84,6 +76,27 @@ bool PluginEditor::keyPressed(const juce::KeyPress& k)
         return true;
     }
 
+#if ANGELS_PERF_INSTRUMENTATION
+    const auto mods = k.getModifiers();
+
+    if (k.isKeyCode('P') && mods.isCommandDown() && mods.isShiftDown())
+    {
+        performanceOverlay.setVisible(!performanceOverlay.isVisible());
+        return true;
+    }
+
+    if (k.isKeyCode('D') && mods.isCommandDown() && mods.isShiftDown())
+    {
+        const auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+            .getChildFile("Angels")
+            .getChildFile("perf-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".txt");
+
+        file.getParentDirectory().createDirectory();
+        processor.getPerformanceMonitor().writeReport(file);
+        return true;
+    }
+#endif
+
     return false;
 }
 
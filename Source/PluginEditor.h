@@ -5,6 +5,8 @@
 #include "PluginProcessor.h"
 #include "EditorContent.h"
 #include "DisplayOverlay.h"
+#include "BackgroundLayer.h"
+#include "PerformanceOverlay.h"
 
 class PluginEditor final : public juce::AudioProcessorEditor
 {
@@ -27,11 +29,17 @@ private:
     PluginProcessor& processor;
     juce::UndoManager& undoManager;
 
+    BackgroundLayer backgroundLayer;
     DisplayOverlay displayOverlay;
 
     MainComponent openGLComponent;
     EditorContent editorContent;
 
+#if ANGELS_PERF_INSTRUMENTATION
+    // Cmd+Shift+P toggles it, Cmd+Shift+D writes a report to the documents folder
+    PerformanceOverlay performanceOverlay;
+#endif
+
     static constexpr auto defaultWidth{ 350 };
     static constexpr auto defaultHeight{ 600 };
 
@@ -57,25 +57,91 @@ static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout
     layout.add(std::make_unique<juce::AudioParameterBool>(
         juce::ParameterID{ "OVERLAY_ON", 1 }, "Overlay On", true));
 
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{ ParameterIDs::preDelay, 1 },
+        "Pre-Delay",
+        juce::NormalisableRange<float>{ 0.0f, 500.0f, 0.1f, 0.5f },
+        0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+
+    // note values match DSPWrapper::preDelaySyncBeats, Off uses the time in ms
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID{ ParameterIDs::preDelaySync, 1 },
+        "Pre-Delay Sync",
+        juce::StringArray{ "Off", "1/64", "1/32", "1/16", "1/8", "1/4", "1/2" },
+        0));
+
+    // decay time per band, relative to the network's own
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{ ParameterIDs::lowDecay, 1 },
+        "Low Decay",
+        juce::NormalisableRange<float>{ 25.0f, 200.0f, 0.01f, 1.0f },
+        100.0f,
+        percentageAttributes));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{ ParameterIDs::midDecay, 1 },
+        "Mid Decay",
+        juce::NormalisableRange<float>{ 25.0f, 200.0f, 0.01f, 1.0f },
+        100.0f,
+        percentageAttributes));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{ ParameterIDs::highDecay, 1 },
+        "High Decay",
+        juce::NormalisableRange<float>{ 25.0f, 200.0f, 0.01f, 1.0f },
+        50.0f,
+        percentageAttributes));
+
+    // wet path ducking, keyed from the sidechain when it's connected, else the dry input
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{ ParameterIDs::duck, 1 },
+        "Duck",
+        juce::NormalisableRange<float>{ 0.0f, 100.0f, 0.01f, 1.0f },
+        0.0f,
+        percentageAttributes));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID{ ParameterIDs::duckRelease, 1 },
+        "Duck Release",
+        juce::NormalisableRange<float>{ 20.0f, 1000.0f, 1.0f, 0.5f },
+        250.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+
     return layout;
 }
 
 PluginProcessor::PluginProcessor()
     : AudioProcessor(BusesProperties()
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
-        .withOutput("Output", juce::AudioChannelSet::stereo(), true))
+        .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+        .withInput("Sidechain", juce::AudioChannelSet::stereo(), false))
     , apvts(*this, &undoManager, "Parameters", createParameterLayout())
 {
     size = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::size));
     damp = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::damp));
     width = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::width));
     mix = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::mix));
+    preDelay = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::preDelay));
+    preDelaySync = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(ParameterIDs::preDelaySync));
+    lowDecay = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::lowDecay));
+    midDecay = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::midDecay));
+    highDecay = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::highDecay));
+    duck = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::duck));
+    duckRelease = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(ParameterIDs::duckRelease));
     //freeze = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(ParameterIDs::freeze));
 
     jassert(size != nullptr);
     jassert(damp != nullptr);
     jassert(width != nullptr);
     jassert(mix != nullptr);
+    jassert(preDelay != nullptr);
+    jassert(preDelaySync != nullptr);
+    jassert(lowDecay != nullptr);
+    jassert(midDecay != nullptr);
+    jassert(highDecay != nullptr);
+    jassert(duck != nullptr);
+    jassert(duckRelease != nullptr);
     //jassert(freeze != nullptr);
 }
 
@@ -108,28 +174,33 @@ bool PluginProcessor::isMidiEffect() const
 #endif
 }
 
-double PluginProcessor::getTailLengthSeconds() const { return 0.0; }
+double PluginProcessor::getTailLengthSeconds() const { return dspWrapper.getTailLengthSeconds(); }
 
-int PluginProcessor::getNumPrograms() { return 1; }
-int PluginProcessor::getCurrentProgram() { return 0; }
-void PluginProcessor::setCurrentProgram(int index) { juce::ignoreUnused(index); }
-const juce::String PluginProcessor::getProgramName(int index) { juce::ignoreUnused(index); return {}; }
+int PluginProcessor::getNumPrograms() { return juce::jmax(1, presetManager.getNumPresets()); }
+int PluginProcessor::getCurrentProgram() { return presetManager.getCurrentPreset(); }
+void PluginProcessor::setCurrentProgram(int index) { presetManager.loadPreset(index); }
+const juce::String PluginProcessor::getProgramName(int index) { return presetManager.getPresetName(index); }
 void PluginProcessor::changeProgramName(int index, const juce::String& newName) { juce::ignoreUnused(index, newName); }
 
 void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     
+    // a double precision host and offline bounces always get the double engine, otherwise
+    // it's the per-instance choice
+    const auto effectivePrecision = isUsingDoublePrecision() || isNonRealtime() ? DSPWrapper::Precision::full
+                                                                                : precisionSetting.load();
+
+    dspWrapper.setOfflineRendering(isNonRealtime());
+    dspWrapper.setNetworkRateLimited(networkRateLimitSetting.load() && !isNonRealtime());
+    dspWrapper.prepare(sampleRate, getMainBusNumInputChannels(), samplesPerBlock, effectivePrecision);
 
-    juce::dsp::ProcessSpec spec{};
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-    spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
+    // the output limiter looks ahead, the host lines everything else up with it
+    setLatencySamples(dspWrapper.getLatencySamples());
 
-    dspWrapper.prepare(sampleRate, getTotalNumInputChannels());
-    limiter.prepare(spec);
-    limiter.reset();
-    limiter.setThreshold(-6.0f);
-    limiter.setRelease(200.0f);
+#if ANGELS_PERF_INSTRUMENTATION
+    performanceMonitor.prepare(sampleRate);
+    dspWrapper.setPerformanceMonitor(&performanceMonitor);
+#endif
 }
 
 void PluginProcessor::releaseResources()
@@ -146,67 +217,172 @@ bool PluginProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
 
+    // the sidechain is optional, mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet(true, 1);
+
+        if (!sidechain.isDisabled() && sidechain != juce::AudioChannelSet::mono() && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
+
     return true;
 }
 
 void PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages); // prevent compiler warnings for unused parameters
+    process(buffer);
+}
+
+void PluginProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    process(buffer);
+}
+
+// the host still gets the latency it was told about while we're bypassed
+void PluginProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    dspWrapper.processBlockBypassed(mainBuffer);
+}
+
+void PluginProcessor::processBlockBypassed(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    dspWrapper.processBlockBypassed(mainBuffer);
+}
+
+template <typename SampleType>
+void PluginProcessor::process(juce::AudioBuffer<SampleType>& buffer)
 {
     // scoped guard against denormalized floating-point numbers
     juce::ScopedNoDenormals noDenormals;
 
-    juce::ignoreUnused(midiMessages); // prevent compiler warnings for unused parameters
+    // compiled out unless ANGELS_PERF_INSTRUMENTATION is on
+    ANGELS_PERF_CALLBACK(performanceMonitor, buffer.getNumSamples());
+
+    // hosts that flip to offline without preparing again still get the render tier, just
+    // without the switch to double precision
+    dspWrapper.setOfflineRendering(isNonRealtime());
+
+    // a preset the loader thread has read, so its values are in this block's parameters
+    presetManager.applyPendingPreset();
 
     // set DSP params
-    dspWrapper.setParameter(ParameterIDs::size, juce::jlimit(0.0f, 1.0f, size->get() * 0.01f));
-    dspWrapper.setParameter(ParameterIDs::damp, juce::jlimit(0.0f, 1.0f, damp->get() * 0.01f));
-    dspWrapper.setParameter(ParameterIDs::width, juce::jlimit(0.0f, 1.0f, width->get() * 0.01f));
-    dspWrapper.setParameter(ParameterIDs::mix, juce::jlimit(0.0f, 1.0f, mix->get() * 0.01f));
-    dspWrapper.setParameter("OVERLAY_ON", apvts.getRawParameterValue("OVERLAY_ON")->load());
+    {
+        ANGELS_PERF_STAGE(&performanceMonitor, parameters);
+        dspWrapper.setParameter(ParameterIDs::size, juce::jlimit(0.0f, 1.0f, size->get() * 0.01f));
+        dspWrapper.setParameter(ParameterIDs::damp, juce::jlimit(0.0f, 1.0f, damp->get() * 0.01f));
+        dspWrapper.setParameter(ParameterIDs::width, juce::jlimit(0.0f, 1.0f, width->get() * 0.01f));
+        dspWrapper.setParameter(ParameterIDs::mix, juce::jlimit(0.0f, 1.0f, mix->get() * 0.01f));
+        dspWrapper.setParameter("OVERLAY_ON", apvts.getRawParameterValue("OVERLAY_ON")->load());
+        dspWrapper.setParameter(ParameterIDs::preDelay, preDelay->get());
+        dspWrapper.setParameter(ParameterIDs::preDelaySync, static_cast<float>(preDelaySync->getIndex()));
+        dspWrapper.setParameter(ParameterIDs::lowDecay, lowDecay->get() * 0.01f);
+        dspWrapper.setParameter(ParameterIDs::midDecay, midDecay->get() * 0.01f);
+        dspWrapper.setParameter(ParameterIDs::highDecay, highDecay->get() * 0.01f);
+        dspWrapper.setParameter(ParameterIDs::duck, duck->get() * 0.01f);
+        dspWrapper.setParameter(ParameterIDs::duckRelease, duckRelease->get());
+
+        // synced pre-delay follows the host tempo, it keeps the last one if the host has none
+        if (auto* playHead = getPlayHead())
+            if (const auto position = playHead->getPosition())
+                if (const auto bpm = position->getBpm())
+                    dspWrapper.setTempo(*bpm);
+
+
+        //update the overlay filter mix based on the overlay parameter.
+        if (auto* blendParam = apvts.getRawParameterValue("OVERLAY_BLEND"))
+        {
+            //  normalize param range it to 0.0–1.0:
+            float blendNormalized = blendParam->load() * 0.01f;
+            dspWrapper.setOverlayMix(blendNormalized);
+        }
+        else
+        {
+            jassertfalse; // overlay parameter not found
+        }
+    }
+
+
 
+    // process the audio block with the DSPWrapper, this includes the output gain and limiter.
+    // the main bus only, the sidechain channels are just the ducker's key. only while the
+    // sidechain is enabled and carries channels though, otherwise the ducker keys off the
+    // dry input. a key of silence would never duck at all
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    auto* sidechainBus = getBus(true, 1);
+    const bool hasSidechain = sidechainBus != nullptr && sidechainBus->isEnabled() && sidechainBus->getNumberOfChannels() > 0;
 
-    //update the overlay filter mix based on the overlay parameter.
-    if (auto* blendParam = apvts.getRawParameterValue("OVERLAY_BLEND"))
+    if (const auto sidechain = hasSidechain ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<SampleType>();
+        sidechain.getNumChannels() > 0)
     {
-        //  normalize param range it to 0.0–1.0:
-        float blendNormalized = blendParam->load() * 0.01f;
-        dspWrapper.setOverlayMix(blendNormalized);
+        dspWrapper.processBlock(mainBuffer, &sidechain);
     }
     else
     {
-        jassertfalse; // overlay parameter not found
+        dspWrapper.processBlock(mainBuffer);
     }
 
+    // only bother the host when the tail moves by more than 10%
+    const double tail = dspWrapper.getTailLengthSeconds();
 
+    if (std::abs(tail - reportedTailSeconds) > 0.1 * juce::jmax(reportedTailSeconds, 0.1))
+    {
+        reportedTailSeconds = tail;
+        triggerAsyncUpdate();
+    }
 
-    // process the audio block with the DSPWrapper
-    dspWrapper.processBlock(buffer);
+}
 
-   
+void PluginProcessor::setPrecision(DSPWrapper::Precision newPrecision)
+{
+    if (precisionSetting.exchange(newPrecision) == newPrecision)
+        return;
 
+    // rebuild the engine at the new precision, with the audio callback held off meanwhile
+    if (getSampleRate() > 0.0 && getBlockSize() > 0)
+    {
+        suspendProcessing(true);
+        prepareToPlay(getSampleRate(), getBlockSize());
+        suspendProcessing(false);
+    }
+}
 
-    // limiter 
-    juce::dsp::AudioBlock<float> limiterBlock(buffer);
-    juce::dsp::ProcessContextReplacing<float> limiterCtx(limiterBlock);
-    //limiter.process(limiterCtx);
+void PluginProcessor::setQuality(DSPWrapper::Quality newQuality)
+{
+    // crossfaded on the audio thread, no need to hold it off
+    qualitySetting.store(newQuality);
+    dspWrapper.setQuality(newQuality);
+}
 
+void PluginProcessor::setQualityGovernorEnabled(bool shouldBeEnabled)
+{
+    qualityGovernorSetting.store(shouldBeEnabled);
+    dspWrapper.setGovernorEnabled(shouldBeEnabled);
+}
 
-    buffer.applyGain(0.75f); 
+void PluginProcessor::setNetworkRateLimited(bool shouldBeLimited)
+{
+    if (networkRateLimitSetting.exchange(shouldBeLimited) == shouldBeLimited)
+        return;
 
-    // soft clipping with tanh
-    const float clipFactor = 0.7f;
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    // the network's delay lines are sized for its rate, so this rebuilds like the precision
+    if (getSampleRate() > 0.0 && getBlockSize() > 0)
     {
-        float* channelData = buffer.getWritePointer(channel);
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            channelData[sample] = std::tanh(channelData[sample] * clipFactor) / std::tanh(clipFactor);
-        }
+        suspendProcessing(true);
+        prepareToPlay(getSampleRate(), getBlockSize());
+        suspendProcessing(false);
     }
+}
 
-    // flush denormalized values
-    buffer.applyGain(0.7f);
-
-   
+void PluginProcessor::handleAsyncUpdate()
+{
+    updateHostDisplay();
 }
 
 bool PluginProcessor::hasEditor() const { return true; }
@@ -214,14 +390,57 @@ juce::AudioProcessorEditor* PluginProcessor::createEditor() { return new PluginE
 
 void PluginProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
-
-    
+    // compact binary block, the full ValueTree is only read back from older sessions
+    const auto programIndex = juce::ByteOrder::swapIfBigEndian(static_cast<juce::uint32>(presetManager.getCurrentPreset()));
+    const auto precisionIndex = juce::ByteOrder::swapIfBigEndian(static_cast<juce::uint32>(precisionSetting.load()));
+
+    // tier in the low byte, governor flag above it, then the full rate flag so older states
+    // load limited
+    const auto qualityValue = juce::ByteOrder::swapIfBigEndian(static_cast<juce::uint32>(qualitySetting.load())
+                                                               | (qualityGovernorSetting.load() ? 0x100u : 0u)
+                                                               | (networkRateLimitSetting.load() ? 0u : 0x200u));
+
+    PluginStateFormat::Extensions extensions(3);
+    extensions[0].id = programChunkId;
+    extensions[0].data.append(&programIndex, sizeof(programIndex));
+    extensions[1].id = precisionChunkId;
+    extensions[1].data.append(&precisionIndex, sizeof(precisionIndex));
+    extensions[2].id = qualityChunkId;
+    extensions[2].data.append(&qualityValue, sizeof(qualityValue));
+
+    stateFormat.write(destData, extensions);
 }
 
 void PluginProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
+    // fast path, sets the parameters directly without rebuilding the state tree
+    PluginStateFormat::Extensions extensions;
+
+    if (stateFormat.read(data, sizeInBytes, &extensions))
+    {
+        for (const auto& chunk : extensions)
+        {
+            if (chunk.data.getSize() != sizeof(juce::uint32))
+                continue;
+
+            const auto value = static_cast<int>(juce::ByteOrder::littleEndianInt(chunk.data.getData()));
+
+            if (chunk.id == programChunkId)
+                presetManager.setCurrentPresetIndex(value);
+            else if (chunk.id == precisionChunkId && juce::isPositiveAndNotGreaterThan(value, static_cast<int>(DSPWrapper::Precision::full)))
+                setPrecision(static_cast<DSPWrapper::Precision>(value));
+            else if (chunk.id == qualityChunkId && juce::isPositiveAndNotGreaterThan(value & 0xff, static_cast<int>(DSPWrapper::Quality::high)))
+            {
+                setQuality(static_cast<DSPWrapper::Quality>(value & 0xff));
+                setQualityGovernorEnabled((value & 0x100) != 0);
+                setNetworkRateLimited((value & 0x200) == 0);
+            }
+        }
+
+        return;
+    }
+
+    // sessions saved before the binary format
     if (const auto tree = juce::ValueTree::readFromData(data, static_cast<size_t>(sizeInBytes)); tree.isValid())
     {
         apvts.replaceState(tree);
@@ -7,8 +7,12 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 #include "DSPWrapper.h"
+#include "PerformanceMonitor.h"
+#include "PluginStateFormat.h"
+#include "PresetManager.h"
 
-class PluginProcessor final : public juce::AudioProcessor
+class PluginProcessor final : public juce::AudioProcessor,
+    private juce::AsyncUpdater
 {
 public:
 
@@ -20,6 +24,10 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -41,21 +49,56 @@ public:
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     juce::AudioProcessorValueTreeState& getPluginState();
+    PresetManager& getPresetManager() { return presetManager; }
+
+    // per-instance precision of the reverb network, saved with the state. ignored while the
+    // host runs us in double precision, which always gets the full double path
+    void setPrecision(DSPWrapper::Precision newPrecision);
+    DSPWrapper::Precision getPrecision() const { return precisionSetting.load(); }
+
+    // per-instance quality tier and whether the governor may drop below it under load,
+    // saved with the state like the precision
+    void setQuality(DSPWrapper::Quality newQuality);
+    DSPWrapper::Quality getQuality() const { return qualitySetting.load(); }
+    void setQualityGovernorEnabled(bool shouldBeEnabled);
+    bool isQualityGovernorEnabled() const { return qualityGovernorSetting.load(); }
+
+    // whether the late reverb runs at 48k or below at high sample rates, saved with the
+    // quality. offline bounces always run it at the full rate
+    void setNetworkRateLimited(bool shouldBeLimited);
+    bool isNetworkRateLimited() const { return networkRateLimitSetting.load(); }
+
+#if ANGELS_PERF_INSTRUMENTATION
+    PerformanceMonitor& getPerformanceMonitor() { return performanceMonitor; }
+#endif
 
 private:
     juce::AudioProcessorValueTreeState apvts;
+    PluginStateFormat stateFormat{ apvts };
 
     juce::AudioParameterFloat* size{ nullptr };
     juce::AudioParameterFloat* damp{ nullptr };
     juce::AudioParameterFloat* width{ nullptr };
     juce::AudioParameterFloat* mix{ nullptr };
     juce::AudioParameterBool* freeze{ nullptr };
+    juce::AudioParameterFloat* preDelay{ nullptr };
+    juce::AudioParameterChoice* preDelaySync{ nullptr };
+    juce::AudioParameterFloat* lowDecay{ nullptr };
+    juce::AudioParameterFloat* midDecay{ nullptr };
+    juce::AudioParameterFloat* highDecay{ nullptr };
+    juce::AudioParameterFloat* duck{ nullptr };
+    juce::AudioParameterFloat* duckRelease{ nullptr };
 
     void updateReverbParams();
 
-    juce::dsp::Reverb::Parameters params;
-    juce::dsp::Reverb reverb;
-    juce::dsp::Limiter<float> limiter;
+    template <typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer);
+
+    // tells the host to re-query the tail length
+    void handleAsyncUpdate() override;
+
+    // last tail length the host was told about, audio thread only
+    double reportedTailSeconds = 0.0;
 
 
 
@@ -64,6 +107,21 @@ private:
     juce::UndoManager undoManager;
 
     DSPWrapper dspWrapper;
+    PresetManager presetManager{ stateFormat, dspWrapper };
+
+    // extension chunk holding the current program index
+    static constexpr juce::uint32 programChunkId = PluginStateFormat::makeChunkId('p', 'r', 'o', 'g');
+    static constexpr juce::uint32 precisionChunkId = PluginStateFormat::makeChunkId('p', 'r', 'e', 'c');
+    static constexpr juce::uint32 qualityChunkId = PluginStateFormat::makeChunkId('q', 'u', 'a', 'l');
+
+    std::atomic<DSPWrapper::Precision> precisionSetting{ DSPWrapper::Precision::single };
+    std::atomic<DSPWrapper::Quality> qualitySetting{ DSPWrapper::Quality::normal };
+    std::atomic<bool> qualityGovernorSetting{ true };
+    std::atomic<bool> networkRateLimitSetting{ true };
+
+#if ANGELS_PERF_INSTRUMENTATION
+    PerformanceMonitor performanceMonitor;
+#endif
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginProcessor)
 };
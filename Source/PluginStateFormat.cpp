@@ -0,0 +1,134 @@
+#include "PluginStateFormat.h"
+#include "ParameterIDs.h"
+
+// append only, see the header
+const std::array<const char*, PluginStateFormat::numParameters> PluginStateFormat::parameterOrder
+{
+    ParameterIDs::size,
+    ParameterIDs::damp,
+    ParameterIDs::width,
+    ParameterIDs::mix,
+    ParameterIDs::overlayBlend,
+    ParameterIDs::overlayOn,
+    ParameterIDs::preDelay,
+    ParameterIDs::preDelaySync,
+    ParameterIDs::lowDecay,
+    ParameterIDs::midDecay,
+    ParameterIDs::highDecay,
+    ParameterIDs::duck,
+    ParameterIDs::duckRelease
+};
+
+PluginStateFormat::PluginStateFormat(juce::AudioProcessorValueTreeState& state)
+{
+    for (size_t i = 0; i < parameterOrder.size(); ++i)
+    {
+        parameters[i] = state.getParameter(parameterOrder[i]);
+        jassert(parameters[i] != nullptr);
+    }
+}
+
+void PluginStateFormat::write(juce::MemoryBlock& destData, const Extensions& extensions) const
+{
+    juce::MemoryOutputStream out(destData, false);
+
+    out.writeInt(static_cast<int>(magic));
+    out.writeShort(static_cast<short>(layoutVersion));
+    out.writeShort(static_cast<short>(parameters.size()));
+
+    for (auto* param : parameters)
+        out.writeFloat(param != nullptr ? param->convertFrom0to1(param->getValue()) : 0.0f);
+
+    out.writeShort(static_cast<short>(extensions.size()));
+
+    for (const auto& chunk : extensions)
+    {
+        out.writeInt(static_cast<int>(chunk.id));
+        out.writeInt(static_cast<int>(chunk.data.getSize()));
+        out.write(chunk.data.getData(), chunk.data.getSize());
+    }
+}
+
+bool PluginStateFormat::read(const void* data, int sizeInBytes, Extensions* extensionsOut) const
+{
+    Values values;
+
+    if (!decode(data, sizeInBytes, values, extensionsOut))
+        return false;
+
+    apply(values);
+    return true;
+}
+
+bool PluginStateFormat::decode(const void* data, int sizeInBytes, Values& values, Extensions* extensionsOut) const
+{
+    constexpr int headerSize = 8;
+
+    if (data == nullptr || sizeInBytes < headerSize)
+        return false;
+
+    juce::MemoryInputStream in(data, static_cast<size_t>(sizeInBytes), false);
+
+    if (static_cast<juce::uint32>(in.readInt()) != magic)
+        return false;
+
+    if ((in.readShort() & 0xffff) != layoutVersion)
+        return false;
+
+    const int numStored = in.readShort() & 0xffff;
+
+    if (in.getNumBytesRemaining() < static_cast<juce::int64>(numStored) * 4)
+        return false;
+
+    // parameters added after this blob was written go back to their defaults
+    for (size_t i = 0; i < parameters.size(); ++i)
+        values[i] = parameters[i] != nullptr ? parameters[i]->convertFrom0to1(parameters[i]->getDefaultValue()) : 0.0f;
+
+    for (int i = 0; i < numStored; ++i)
+    {
+        const float value = in.readFloat();
+
+        // values from a newer build with more parameters are skipped
+        if (i < static_cast<int>(parameters.size()) && std::isfinite(value))
+            values[static_cast<size_t>(i)] = value;
+    }
+
+    if (extensionsOut == nullptr || in.getNumBytesRemaining() < 2)
+        return true;
+
+    const int numChunks = in.readShort() & 0xffff;
+
+    for (int i = 0; i < numChunks && in.getNumBytesRemaining() >= 8; ++i)
+    {
+        Chunk chunk;
+        chunk.id = static_cast<juce::uint32>(in.readInt());
+        const auto chunkSize = static_cast<juce::int64>(static_cast<juce::uint32>(in.readInt()));
+
+        // truncated blob, keep the parameters and whatever chunks were complete
+        if (chunkSize > in.getNumBytesRemaining())
+            break;
+
+        chunk.data.setSize(static_cast<size_t>(chunkSize));
+        in.read(chunk.data.getData(), static_cast<int>(chunkSize));
+        extensionsOut->push_back(std::move(chunk));
+    }
+
+    return true;
+}
+
+void PluginStateFormat::apply(const Values& values) const
+{
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        auto* param = parameters[i];
+
+        if (param == nullptr)
+            continue;
+
+        const float normalised = param->convertTo0to1(values[i]);
+
+        // only the parameters that actually change notify the host
+        if (std::abs(normalised - param->getValue()) > 1.0e-6f)
+            param->setValueNotifyingHost(normalised);
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+// compact binary plugin state, used instead of streaming the whole APVTS ValueTree.
+//
+//   uint32  magic "ANGL"
+//   uint16  layout version
+//   uint16  number of parameter values
+//   float   plain parameter values, in parameterOrder
+//   uint16  number of extension chunks
+//   chunks  { uint32 id, uint32 size, size bytes }
+//
+// all little endian. parameters are only ever appended to parameterOrder, older blobs just
+// have fewer values; the layout version only changes if that rule has to be broken.
+// unknown chunks are skipped, so new extensions don't break older builds.
+class PluginStateFormat
+{
+public:
+    struct Chunk
+    {
+        juce::uint32 id = 0;
+        juce::MemoryBlock data;
+    };
+
+    using Extensions = std::vector<Chunk>;
+
+    // positions in parameterOrder
+    enum ParameterIndex : size_t
+    {
+        sizeIndex,
+        dampIndex,
+        widthIndex,
+        mixIndex,
+        overlayBlendIndex,
+        overlayOnIndex,
+        preDelayIndex,
+        preDelaySyncIndex,
+        lowDecayIndex,
+        midDecayIndex,
+        highDecayIndex,
+        duckIndex,
+        duckReleaseIndex
+    };
+
+    static constexpr juce::uint32 magic = 0x4c474e41;     // "ANGL" read as little endian
+    static constexpr int layoutVersion = 1;
+    static constexpr size_t numParameters = 13;
+
+    // plain parameter values, in parameterOrder
+    using Values = std::array<float, numParameters>;
+
+    explicit PluginStateFormat(juce::AudioProcessorValueTreeState& state);
+
+    void write(juce::MemoryBlock& destData, const Extensions& extensions = {}) const;
+
+    // fast path: applies the stored values straight to the parameters, only notifying the
+    // host for the ones that actually change. returns false if the data isn't in this
+    // format or has a different layout version, nothing is touched in that case
+    bool read(const void* data, int sizeInBytes, Extensions* extensionsOut = nullptr) const;
+
+    // read() split in two, for callers that want to look at the values before applying them.
+    // decode fills in defaults for parameters the data doesn't have
+    bool decode(const void* data, int sizeInBytes, Values& values, Extensions* extensionsOut = nullptr) const;
+    void apply(const Values& values) const;
+
+    static constexpr juce::uint32 makeChunkId(char a, char b, char c, char d)
+    {
+        return static_cast<juce::uint32>(static_cast<juce::uint8>(a))
+            | (static_cast<juce::uint32>(static_cast<juce::uint8>(b)) << 8)
+            | (static_cast<juce::uint32>(static_cast<juce::uint8>(c)) << 16)
+            | (static_cast<juce::uint32>(static_cast<juce::uint8>(d)) << 24);
+    }
+
+private:
+    static const std::array<const char*, numParameters> parameterOrder;
+
+    std::array<juce::RangedAudioParameter*, numParameters> parameters{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginStateFormat)
+};
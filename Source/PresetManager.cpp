@@ -0,0 +1,242 @@
+#include "PresetManager.h"
+
+// size, decay, width, mix, overlay blend, overlay on, pre-delay ms, pre-delay sync,
+// low / mid / high decay, duck, duck release ms; plain values in PluginStateFormat order
+const std::array<PresetManager::FactoryPreset, 6> PresetManager::factoryPresets
+{ {
+    { "Init",       { 0.0f,  0.0f,  0.0f,   100.0f, 50.0f, 1.0f, 0.0f,  0.0f, 100.0f, 100.0f, 50.0f, 0.0f,  250.0f } },
+    { "Small Room", { 20.0f, 30.0f, 40.0f,  35.0f,  20.0f, 0.0f, 5.0f,  0.0f, 80.0f,  100.0f, 40.0f, 0.0f,  250.0f } },
+    { "Hall",       { 55.0f, 50.0f, 70.0f,  45.0f,  30.0f, 0.0f, 20.0f, 0.0f, 120.0f, 100.0f, 60.0f, 0.0f,  250.0f } },
+    { "Cathedral",  { 90.0f, 75.0f, 85.0f,  55.0f,  25.0f, 0.0f, 40.0f, 0.0f, 150.0f, 100.0f, 70.0f, 0.0f,  250.0f } },
+    { "Wide Wash",  { 70.0f, 60.0f, 100.0f, 70.0f,  40.0f, 1.0f, 30.0f, 0.0f, 110.0f, 100.0f, 60.0f, 50.0f, 300.0f } },
+    { "Vile",       { 50.0f, 40.0f, 60.0f,  80.0f,  90.0f, 1.0f, 0.0f,  0.0f, 100.0f, 100.0f, 50.0f, 0.0f,  250.0f } }
+} };
+
+PresetManager::PresetManager(PluginStateFormat& format, DSPWrapper& dsp)
+    : stateFormat(format),
+    dspWrapper(dsp)
+{
+    refreshUserPresets();
+}
+
+int PresetManager::getNumPresets() const
+{
+    return static_cast<int>(factoryPresets.size()) + numUserPresets.load();
+}
+
+juce::String PresetManager::getPresetName(int index) const
+{
+    const int numFactory = static_cast<int>(factoryPresets.size());
+
+    if (juce::isPositiveAndBelow(index, numFactory))
+        return factoryPresets[static_cast<size_t>(index)].name;
+
+    if (juce::isPositiveAndBelow(index - numFactory, userPresets.size()))
+        return userPresets[index - numFactory].getFileNameWithoutExtension();
+
+    return {};
+}
+
+void PresetManager::setCurrentPresetIndex(int index)
+{
+    if (juce::isPositiveAndBelow(index, getNumPresets()))
+        currentPreset = index;
+}
+
+// a load request on the shared loader, removed by its manager's destructor if it hasn't run
+class PresetManager::LoadJob : public juce::ThreadPoolJob
+{
+public:
+    explicit LoadJob(PresetManager& managerToUse)
+        : juce::ThreadPoolJob("Angels preset loader"),
+        manager(managerToUse)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        manager.runLoad();
+        return jobHasFinished;
+    }
+
+    PresetManager& manager;
+};
+
+PresetManager::~PresetManager()
+{
+    // the loader is shared, only this instance's jobs go, waiting for one that's running
+    struct OwnJobs : juce::ThreadPool::JobSelector
+    {
+        explicit OwnJobs(const PresetManager& ownerToMatch) : owner(ownerToMatch) {}
+
+        bool isJobSuitable(juce::ThreadPoolJob* job) override
+        {
+            auto* load = dynamic_cast<LoadJob*>(job);
+            return load != nullptr && &load->manager == &owner;
+        }
+
+        const PresetManager& owner;
+    };
+
+    OwnJobs ownJobs{ *this };
+    loader->pool.removeAllJobs(true, -1, &ownJobs);
+    cancelPendingUpdate();
+}
+
+bool PresetManager::readPreset(int index, PluginStateFormat::Values& values)
+{
+    const int numFactory = static_cast<int>(factoryPresets.size());
+
+    if (juce::isPositiveAndBelow(index, numFactory))
+    {
+        values = factoryPresets[static_cast<size_t>(index)].values;
+    }
+    else if (juce::isPositiveAndBelow(index - numFactory, userPresets.size()))
+    {
+        juce::MemoryBlock data;
+
+        if (!userPresets[index - numFactory].loadFileAsData(data)
+            || !stateFormat.decode(data.getData(), static_cast<int>(data.getSize()), values))
+            return false;
+    }
+    else
+    {
+        return false;
+    }
+
+    // same scaling PluginProcessor applies before handing the values to the DSP
+    const float size = juce::jlimit(0.0f, 1.0f, values[PluginStateFormat::sizeIndex] * 0.01f);
+    const float decay = juce::jlimit(0.0f, 1.0f, values[PluginStateFormat::dampIndex] * 0.01f);
+
+    DecayBands bands;
+    bands.low = values[PluginStateFormat::lowDecayIndex] * 0.01f;
+    bands.mid = values[PluginStateFormat::midDecayIndex] * 0.01f;
+    bands.high = values[PluginStateFormat::highDecayIndex] * 0.01f;
+
+    // the tuning goes to the DSP first, so it's waiting when the parameters change
+    dspWrapper.postTuning(CustomReverb::makeTuning(size, decay, dspWrapper.getSampleRate(), bands,
+                                                   dspWrapper.isNetworkRateLimited()));
+    return true;
+}
+
+void PresetManager::loadPreset(int index)
+{
+    // on the message thread it's done before this returns, so a host that renders straight
+    // after recalling hears the preset
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        PluginStateFormat::Values values;
+
+        if (readPreset(index, values))
+        {
+            currentPreset = index;
+            stateFormat.apply(values);
+        }
+
+        return;
+    }
+
+    // from any other thread, maybe the audio thread, nothing here touches the disk. requests
+    // that pile up before the loader gets to them collapse to the last one
+    if (!juce::isPositiveAndBelow(index, getNumPresets()))
+        return;
+
+    currentPreset = index;
+    requestedPreset = index;
+    loader->pool.addJob(new LoadJob(*this), true);
+}
+
+void PresetManager::runLoad()
+{
+    const int index = requestedPreset.exchange(-1);
+    PluginStateFormat::Values values;
+
+    if (index < 0 || !readPreset(index, values))
+        return;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(loadedValuesLock);
+        loadedValues = values;
+        hasLoadedValues.store(true, std::memory_order_release);
+    }
+
+    // the audio thread usually gets there first, this covers a host that isn't processing.
+    // neither waits on the other, a headless host that never runs a message loop still
+    // gets the preset on its next block
+    triggerAsyncUpdate();
+}
+
+void PresetManager::applyPendingPreset()
+{
+    if (!hasLoadedValues.load(std::memory_order_acquire))
+        return;
+
+    PluginStateFormat::Values values;
+
+    {
+        const juce::SpinLock::ScopedTryLockType lock(loadedValuesLock);
+
+        if (!lock.isLocked() || !hasLoadedValues.load(std::memory_order_relaxed))
+            return;
+
+        values = loadedValues;
+        hasLoadedValues.store(false, std::memory_order_relaxed);
+    }
+
+    stateFormat.apply(values);
+}
+
+void PresetManager::handleAsyncUpdate()
+{
+    applyPendingPreset();
+}
+
+bool PresetManager::saveUserPreset(const juce::String& name)
+{
+    const auto legalName = juce::File::createLegalFileName(name.trim());
+
+    if (legalName.isEmpty())
+        return false;
+
+    const auto directory = getUserPresetDirectory();
+
+    if (!directory.createDirectory())
+        return false;
+
+    juce::MemoryBlock data;
+    stateFormat.write(data);
+
+    const auto file = directory.getChildFile(legalName).withFileExtension(fileExtension);
+
+    if (!file.replaceWithData(data.getData(), data.getSize()))
+        return false;
+
+    refreshUserPresets();
+    currentPreset = static_cast<int>(factoryPresets.size()) + userPresets.indexOf(file);
+    return true;
+}
+
+void PresetManager::refreshUserPresets()
+{
+    auto files = getUserPresetDirectory().findChildFiles(juce::File::findFiles, false,
+        juce::String("*") + fileExtension);
+
+    // stable program numbers for the host, whatever order the file system lists them in
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getFileName().compareIgnoreCase(b.getFileName()) < 0;
+    });
+
+    // the loader thread reads the list too
+    const juce::ScopedLock lock(userPresets.getLock());
+    userPresets.clearQuick();
+    userPresets.addArray(files);
+    numUserPresets = userPresets.size();
+}
+
+juce::File PresetManager::getUserPresetDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Angels")
+        .getChildFile("Presets");
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "PluginStateFormat.h"
+#include "DSPWrapper.h"
+
+// factory presets plus user presets saved as files, exposed to the host as programs.
+// loading works out the reverb tuning for the new values and hands it to the DSP before the
+// parameters change, the DSP then ramps to the new settings. off the message thread the file
+// is read and the tuning worked out on a loader thread shared by every instance, and the
+// parameters change on the audio or message thread, whichever gets there first.
+class PresetManager : private juce::AsyncUpdater
+{
+public:
+    PresetManager(PluginStateFormat& format, DSPWrapper& dsp);
+    ~PresetManager() override;
+
+    int getNumPresets() const;
+    juce::String getPresetName(int index) const;
+
+    int getCurrentPreset() const { return currentPreset.load(); }
+
+    // restores the index from saved state, without loading anything
+    void setCurrentPresetIndex(int index);
+
+    void loadPreset(int index);
+
+    // applies a preset the loader has finished with, if there is one. called at the top of
+    // every block, never blocks
+    void applyPendingPreset();
+
+    // saves the current parameter values as a user preset, replacing one with the same name
+    bool saveUserPreset(const juce::String& name);
+    void refreshUserPresets();
+
+    static juce::File getUserPresetDirectory();
+    static constexpr auto fileExtension{ ".angelspreset" };
+
+private:
+    struct FactoryPreset
+    {
+        const char* name;
+        PluginStateFormat::Values values;
+    };
+
+    static const std::array<FactoryPreset, 6> factoryPresets;
+
+    // one thread for every instance in the process, made with the first one
+    struct SharedLoader
+    {
+        juce::ThreadPool pool{ 1 };
+    };
+
+    class LoadJob;
+
+    // the preset's values, from the table or its file, and its tuning handed to the DSP
+    bool readPreset(int index, PluginStateFormat::Values& values);
+
+    // loader thread, picks up the latest requested index
+    void runLoad();
+
+    void handleAsyncUpdate() override;
+
+    PluginStateFormat& stateFormat;
+    DSPWrapper& dspWrapper;
+
+    juce::Array<juce::File, juce::CriticalSection> userPresets;
+    std::atomic<int> numUserPresets{ 0 };
+    std::atomic<int> currentPreset{ 0 };
+
+    // latest index asked for off the message thread, -1 once the loader has taken it
+    std::atomic<int> requestedPreset{ -1 };
+
+    // values the loader has read, waiting for the audio or message thread
+    PluginStateFormat::Values loadedValues{};
+    juce::SpinLock loadedValuesLock;
+    std::atomic<bool> hasLoadedValues{ false };
+
+    juce::SharedResourcePointer<SharedLoader> loader;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetManager)
+};
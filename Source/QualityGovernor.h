@@ -0,0 +1,79 @@
+#pragma once
+#include <JuceHeader.h>
+
+// steps the reverb down a quality tier when it takes more than its share of the audio
+// callback, and back up once there has been headroom for a while. fed once per block with how
+// long this instance took to process the block against how long the block lasts. it only
+// ever sees its own time, while the host has to fit every plugin on every track into the same
+// deadline, so the budget is what one instance can reasonably claim rather than the deadline
+// itself: by the time a single instance is near the deadline the host has long overrun
+class QualityGovernor
+{
+public:
+    static constexpr double stepDownLoad = 0.15;
+    static constexpr double stepUpLoad = 0.06;          // a tier up roughly doubles the load, stays under stepDownLoad
+    static constexpr double stepUpHoldSeconds = 3.0;
+    static constexpr double settleSeconds = 0.5;        // ignore the blocks straight after a change
+    static constexpr int maxStepsDown = 2;
+
+    void reset()
+    {
+        load = 0.0;
+        headroomSeconds = 0.0;
+        settleRemaining = 0.0;
+        stepsDown = 0;
+    }
+
+    // tiers below the chosen one to run at
+    int getStepsDown() const { return stepsDown; }
+
+    int update(double elapsedSeconds, double blockSeconds)
+    {
+        if (blockSeconds <= 0.0)
+            return stepsDown;
+
+        // rises fast and falls slowly, a single late block on its own doesn't count for much
+        const double blockLoad = elapsedSeconds / blockSeconds;
+        load += (blockLoad - load) * (blockLoad > load ? 0.3 : 0.05);
+
+        if (settleRemaining > 0.0)
+        {
+            settleRemaining -= blockSeconds;
+            return stepsDown;
+        }
+
+        if (load > stepDownLoad && stepsDown < maxStepsDown)
+        {
+            ++stepsDown;
+            changed();
+        }
+        else if (load < stepUpLoad && stepsDown > 0)
+        {
+            headroomSeconds += blockSeconds;
+
+            if (headroomSeconds >= stepUpHoldSeconds)
+            {
+                --stepsDown;
+                changed();
+            }
+        }
+        else
+        {
+            headroomSeconds = 0.0;
+        }
+
+        return stepsDown;
+    }
+
+private:
+    void changed()
+    {
+        headroomSeconds = 0.0;
+        settleRemaining = settleSeconds;
+    }
+
+    double load = 0.0;
+    double headroomSeconds = 0.0;
+    double settleRemaining = 0.0;
+    int stepsDown = 0;
+};
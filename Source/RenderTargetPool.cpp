@@ -0,0 +1,135 @@
+#include "RenderTargetPool.h"
+
+using namespace juce::gl;
+
+RenderTargetPool::~RenderTargetPool()
+{
+    // release() must run on the GL thread, from MainComponent::shutdown()
+    jassert(framebuffer == 0);
+}
+
+bool RenderTargetPool::prepare(int newWidth, int newHeight, bool needsMotionTarget)
+{
+    newWidth = juce::jmax(1, newWidth);
+    newHeight = juce::jmax(1, newHeight);
+
+    bool changed = false;
+
+    if (framebuffer == 0)
+    {
+        glGenFramebuffers(1, &framebuffer);
+        glGenTextures(1, &colourTexture);
+        changed = true;
+    }
+
+    // grow past the current capacity, or shrink once less than half of it is used
+    const bool tooSmall = newWidth > capacityWidth || newHeight > capacityHeight;
+    const bool tooLarge = newWidth * 2 < capacityWidth || newHeight * 2 < capacityHeight;
+
+    if (changed || tooSmall || tooLarge)
+    {
+        capacityWidth = roundUpToGranularity(newWidth);
+        capacityHeight = roundUpToGranularity(newHeight);
+
+        allocateTexture(colourTexture, false);
+        if (motionTexture != 0)
+            allocateTexture(motionTexture, true);
+
+        changed = true;
+    }
+
+    width = newWidth;
+    height = newHeight;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    if (changed)
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colourTexture, 0);
+
+    // motion vectors only exist while motion blur is on
+    if (needsMotionTarget && motionTexture == 0)
+    {
+        glGenTextures(1, &motionTexture);
+        allocateTexture(motionTexture, true);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, motionTexture, 0);
+        changed = true;
+    }
+    else if (!needsMotionTarget && motionTexture != 0)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, 0, 0);
+        glDeleteTextures(1, &motionTexture);
+        motionTexture = 0;
+        changed = true;
+    }
+    else if (changed && motionTexture != 0)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, motionTexture, 0);
+    }
+
+    bool complete = true;
+
+    if (changed)
+    {
+        updateDrawBuffers();
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            juce::Logger::writeToLog("Scene framebuffer is not complete!");
+            complete = false;
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+void RenderTargetPool::release()
+{
+    if (colourTexture != 0)
+    {
+        glDeleteTextures(1, &colourTexture);
+        colourTexture = 0;
+    }
+
+    if (motionTexture != 0)
+    {
+        glDeleteTextures(1, &motionTexture);
+        motionTexture = 0;
+    }
+
+    if (framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+
+    width = height = 0;
+    capacityWidth = capacityHeight = 0;
+}
+
+void RenderTargetPool::allocateTexture(GLuint texture, bool isMotion) const
+{
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    if (isMotion)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, capacityWidth, capacityHeight, 0, GL_RG, GL_FLOAT, nullptr);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, capacityWidth, capacityHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void RenderTargetPool::updateDrawBuffers() const
+{
+    GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(motionTexture != 0 ? 2 : 1, buffers);
+}
+
+int RenderTargetPool::roundUpToGranularity(int size)
+{
+    return ((size + granularity - 1) / granularity) * granularity;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// offscreen scene targets for MainComponent, created and resized on the GL thread only.
+// textures are allocated in 64px steps and reused while the view fits inside them,
+// so dragging the window doesn't reallocate on every pixel.
+class RenderTargetPool
+{
+public:
+    ~RenderTargetPool();
+
+    // call from render() before drawing; (re)allocates only when the size no longer fits
+    bool prepare(int newWidth, int newHeight, bool needsMotionTarget);
+    void release();
+
+    GLuint getFramebuffer() const { return framebuffer; }
+    GLuint getColourTexture() const { return colourTexture; }
+    GLuint getMotionTexture() const { return motionTexture; }   // 0 unless motion blur is on
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // fraction of each texture covered by the current view
+    float getUScale() const { return capacityWidth > 0 ? static_cast<float>(width) / static_cast<float>(capacityWidth) : 1.0f; }
+    float getVScale() const { return capacityHeight > 0 ? static_cast<float>(height) / static_cast<float>(capacityHeight) : 1.0f; }
+
+private:
+    void allocateTexture(GLuint texture, bool isMotion) const;
+    void updateDrawBuffers() const;
+    static int roundUpToGranularity(int size);
+
+    GLuint framebuffer = 0;
+    GLuint colourTexture = 0;
+    GLuint motionTexture = 0;
+
+    int width = 0, height = 0;
+    int capacityWidth = 0, capacityHeight = 0;
+
+    static constexpr int granularity = 64;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderTargetPool)
+};
@@ -0,0 +1,474 @@
+#include "SimdKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define ANGELS_SIMD_X86 1
+ #include <immintrin.h>
+#else
+ #define ANGELS_SIMD_X86 0
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+ #define ANGELS_SIMD_NEON 1
+ #include <arm_neon.h>
+#else
+ #define ANGELS_SIMD_NEON 0
+#endif
+
+// each variant is compiled for its own instruction set whatever the project's flags, gcc and
+// clang through a target region, msvc takes the intrinsics anywhere. nothing outside a region
+// uses a wider set than the baseline and nothing inside one runs before cpuHas says so, so
+// the binary still loads and runs on any cpu
+namespace SimdKernels
+{
+namespace
+{
+    template <typename SampleType>
+    alignas(64) constexpr SampleType iotaValues[16]{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+    namespace scalar
+    {
+        template <typename SampleType> struct ScalarLanes;
+        template <typename SampleType> using Lanes = ScalarLanes<SampleType>;
+
+        #include "SimdKernelsImpl.h"
+    }
+
+#if ANGELS_SIMD_X86
+
+    namespace sse2
+    {
+        template <typename SampleType> struct Lanes;
+
+        template <>
+        struct Lanes<float>
+        {
+            using Type = __m128;
+            static constexpr int width = 4;
+
+            static Type set(float x) { return _mm_set1_ps(x); }
+            static Type load(const float* p) { return _mm_loadu_ps(p); }
+            static void store(float* p, Type x) { _mm_storeu_ps(p, x); }
+            static Type add(Type a, Type b) { return _mm_add_ps(a, b); }
+            static Type sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+            static Type mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+            static Type div(Type a, Type b) { return _mm_div_ps(a, b); }
+            static Type min(Type a, Type b) { return _mm_min_ps(a, b); }
+            static Type max(Type a, Type b) { return _mm_max_ps(a, b); }
+            static Type round(Type x) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(x)); }   // sse2 has no round, fine below 2^31
+            static Type iota() { return _mm_load_ps(iotaValues<float>); }
+        };
+
+        template <>
+        struct Lanes<double>
+        {
+            using Type = __m128d;
+            static constexpr int width = 2;
+
+            static Type set(double x) { return _mm_set1_pd(x); }
+            static Type load(const double* p) { return _mm_loadu_pd(p); }
+            static void store(double* p, Type x) { _mm_storeu_pd(p, x); }
+            static Type add(Type a, Type b) { return _mm_add_pd(a, b); }
+            static Type sub(Type a, Type b) { return _mm_sub_pd(a, b); }
+            static Type mul(Type a, Type b) { return _mm_mul_pd(a, b); }
+            static Type div(Type a, Type b) { return _mm_div_pd(a, b); }
+            static Type min(Type a, Type b) { return _mm_min_pd(a, b); }
+            static Type max(Type a, Type b) { return _mm_max_pd(a, b); }
+            static Type round(Type x) { return _mm_cvtepi32_pd(_mm_cvtpd_epi32(x)); }
+            static Type iota() { return _mm_load_pd(iotaValues<double>); }
+        };
+
+        #include "SimdKernelsImpl.h"
+    }
+
+#if defined(__clang__)
+ #pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target("avx2,fma")
+#endif
+
+    namespace avx2
+    {
+        template <typename SampleType> struct Lanes;
+
+        template <>
+        struct Lanes<float>
+        {
+            using Type = __m256;
+            static constexpr int width = 8;
+
+            static Type set(float x) { return _mm256_set1_ps(x); }
+            static Type load(const float* p) { return _mm256_loadu_ps(p); }
+            static void store(float* p, Type x) { _mm256_storeu_ps(p, x); }
+            static Type add(Type a, Type b) { return _mm256_add_ps(a, b); }
+            static Type sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+            static Type mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+            static Type div(Type a, Type b) { return _mm256_div_ps(a, b); }
+            static Type min(Type a, Type b) { return _mm256_min_ps(a, b); }
+            static Type max(Type a, Type b) { return _mm256_max_ps(a, b); }
+            static Type round(Type x) { return _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static Type iota() { return _mm256_load_ps(iotaValues<float>); }
+        };
+
+        template <>
+        struct Lanes<double>
+        {
+            using Type = __m256d;
+            static constexpr int width = 4;
+
+            static Type set(double x) { return _mm256_set1_pd(x); }
+            static Type load(const double* p) { return _mm256_loadu_pd(p); }
+            static void store(double* p, Type x) { _mm256_storeu_pd(p, x); }
+            static Type add(Type a, Type b) { return _mm256_add_pd(a, b); }
+            static Type sub(Type a, Type b) { return _mm256_sub_pd(a, b); }
+            static Type mul(Type a, Type b) { return _mm256_mul_pd(a, b); }
+            static Type div(Type a, Type b) { return _mm256_div_pd(a, b); }
+            static Type min(Type a, Type b) { return _mm256_min_pd(a, b); }
+            static Type max(Type a, Type b) { return _mm256_max_pd(a, b); }
+            static Type round(Type x) { return _mm256_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static Type iota() { return _mm256_load_pd(iotaValues<double>); }
+        };
+
+        #include "SimdKernelsImpl.h"
+    }
+
+#if defined(__clang__)
+ #pragma clang attribute pop
+ #pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+ #pragma GCC pop_options
+ #pragma GCC push_options
+ #pragma GCC target("avx512f")
+#endif
+
+    namespace avx512
+    {
+        template <typename SampleType> struct Lanes;
+
+        template <>
+        struct Lanes<float>
+        {
+            using Type = __m512;
+            static constexpr int width = 16;
+
+            static Type set(float x) { return _mm512_set1_ps(x); }
+            static Type load(const float* p) { return _mm512_loadu_ps(p); }
+            static void store(float* p, Type x) { _mm512_storeu_ps(p, x); }
+            static Type add(Type a, Type b) { return _mm512_add_ps(a, b); }
+            static Type sub(Type a, Type b) { return _mm512_sub_ps(a, b); }
+            static Type mul(Type a, Type b) { return _mm512_mul_ps(a, b); }
+            static Type div(Type a, Type b) { return _mm512_div_ps(a, b); }
+            static Type min(Type a, Type b) { return _mm512_min_ps(a, b); }
+            static Type max(Type a, Type b) { return _mm512_max_ps(a, b); }
+            static Type round(Type x) { return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static Type iota() { return _mm512_load_ps(iotaValues<float>); }
+        };
+
+        template <>
+        struct Lanes<double>
+        {
+            using Type = __m512d;
+            static constexpr int width = 8;
+
+            static Type set(double x) { return _mm512_set1_pd(x); }
+            static Type load(const double* p) { return _mm512_loadu_pd(p); }
+            static void store(double* p, Type x) { _mm512_storeu_pd(p, x); }
+            static Type add(Type a, Type b) { return _mm512_add_pd(a, b); }
+            static Type sub(Type a, Type b) { return _mm512_sub_pd(a, b); }
+            static Type mul(Type a, Type b) { return _mm512_mul_pd(a, b); }
+            static Type div(Type a, Type b) { return _mm512_div_pd(a, b); }
+            static Type min(Type a, Type b) { return _mm512_min_pd(a, b); }
+            static Type max(Type a, Type b) { return _mm512_max_pd(a, b); }
+            static Type round(Type x) { return _mm512_roundscale_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static Type iota() { return _mm512_load_pd(iotaValues<double>); }
+        };
+
+        #include "SimdKernelsImpl.h"
+    }
+
+#if defined(__clang__)
+ #pragma clang attribute pop
+#elif defined(__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+#endif // ANGELS_SIMD_X86
+
+#if ANGELS_SIMD_NEON
+
+    // advsimd is part of every arm64 cpu, no region needed
+    namespace neon
+    {
+        template <typename SampleType> struct Lanes;
+
+        template <>
+        struct Lanes<float>
+        {
+            using Type = float32x4_t;
+            static constexpr int width = 4;
+
+            static Type set(float x) { return vdupq_n_f32(x); }
+            static Type load(const float* p) { return vld1q_f32(p); }
+            static void store(float* p, Type x) { vst1q_f32(p, x); }
+            static Type add(Type a, Type b) { return vaddq_f32(a, b); }
+            static Type sub(Type a, Type b) { return vsubq_f32(a, b); }
+            static Type mul(Type a, Type b) { return vmulq_f32(a, b); }
+            static Type div(Type a, Type b) { return vdivq_f32(a, b); }
+            static Type min(Type a, Type b) { return vminq_f32(a, b); }
+            static Type max(Type a, Type b) { return vmaxq_f32(a, b); }
+            static Type round(Type x) { return vrndnq_f32(x); }
+            static Type iota() { return vld1q_f32(iotaValues<float>); }
+        };
+
+        template <>
+        struct Lanes<double>
+        {
+            using Type = float64x2_t;
+            static constexpr int width = 2;
+
+            static Type set(double x) { return vdupq_n_f64(x); }
+            static Type load(const double* p) { return vld1q_f64(p); }
+            static void store(double* p, Type x) { vst1q_f64(p, x); }
+            static Type add(Type a, Type b) { return vaddq_f64(a, b); }
+            static Type sub(Type a, Type b) { return vsubq_f64(a, b); }
+            static Type mul(Type a, Type b) { return vmulq_f64(a, b); }
+            static Type div(Type a, Type b) { return vdivq_f64(a, b); }
+            static Type min(Type a, Type b) { return vminq_f64(a, b); }
+            static Type max(Type a, Type b) { return vmaxq_f64(a, b); }
+            static Type round(Type x) { return vrndnq_f64(x); }
+            static Type iota() { return vld1q_f64(iotaValues<double>); }
+        };
+
+        #include "SimdKernelsImpl.h"
+    }
+
+#endif // ANGELS_SIMD_NEON
+
+    struct Variant
+    {
+        Table<float> floats{};
+        Table<double> doubles{};
+        bool compiled = false;
+    };
+
+    // out here in baseline code, only taking the kernels' addresses. built inside a region even
+    // filling in a table is fair game for the wider registers, and every variant's table is
+    // built on every cpu
+    #define ANGELS_SIMD_TABLE(isa, SampleType) \
+        Table<SampleType>{ &isa::mix<SampleType>, &isa::limit<SampleType>, &isa::vile<SampleType>, \
+                           &isa::onePole<SampleType>, &isa::allPass<SampleType> }
+
+    #define ANGELS_SIMD_VARIANT(isa) \
+        Variant{ ANGELS_SIMD_TABLE(isa, float), ANGELS_SIMD_TABLE(isa, double), true }
+
+    const std::array<Variant, static_cast<size_t>(Isa::numIsas)>& getVariants()
+    {
+        static const auto variants = []
+        {
+            std::array<Variant, static_cast<size_t>(Isa::numIsas)> v;
+            v[static_cast<size_t>(Isa::scalar)] = ANGELS_SIMD_VARIANT(scalar);
+           #if ANGELS_SIMD_X86
+            v[static_cast<size_t>(Isa::sse2)] = ANGELS_SIMD_VARIANT(sse2);
+            v[static_cast<size_t>(Isa::avx2)] = ANGELS_SIMD_VARIANT(avx2);
+            v[static_cast<size_t>(Isa::avx512)] = ANGELS_SIMD_VARIANT(avx512);
+           #endif
+           #if ANGELS_SIMD_NEON
+            v[static_cast<size_t>(Isa::neon)] = ANGELS_SIMD_VARIANT(neon);
+           #endif
+            return v;
+        }();
+
+        return variants;
+    }
+
+    #undef ANGELS_SIMD_VARIANT
+    #undef ANGELS_SIMD_TABLE
+
+    bool cpuHas(Isa isa)
+    {
+        switch (isa)
+        {
+            case Isa::scalar:   return true;
+            case Isa::sse2:     return juce::SystemStats::hasSSE2();
+            case Isa::avx2:     return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+            case Isa::avx512:   return juce::SystemStats::hasAVX512F();
+            case Isa::neon:     return true;    // only compiled for arm64
+            case Isa::numIsas:  break;
+        }
+
+        return false;
+    }
+
+    Isa chooseIsa()
+    {
+        // the override, if it names something this cpu can run
+        const auto requested = juce::SystemStats::getEnvironmentVariable("ANGELS_SIMD", {}).trim().toLowerCase();
+
+        for (int i = 0; i < static_cast<int>(Isa::numIsas); ++i)
+            if (requested.isNotEmpty() && requested == getIsaName(static_cast<Isa>(i)) && isSupported(static_cast<Isa>(i)))
+                return static_cast<Isa>(i);
+
+        for (auto isa : { Isa::avx512, Isa::avx2, Isa::neon, Isa::sse2 })
+            if (isSupported(isa))
+                return isa;
+
+        return Isa::scalar;
+    }
+
+    std::atomic<Isa>& activeIsa()
+    {
+        static std::atomic<Isa> isa{ chooseIsa() };
+        return isa;
+    }
+
+    template <typename SampleType>
+    const Table<SampleType>& getTable(const Variant& variant)
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return variant.floats;
+        else
+            return variant.doubles;
+    }
+
+    // largest difference from the scalar variant over every kernel, name of the worst
+    template <typename SampleType>
+    juce::String checkVariant(Isa isa, SampleType tolerance)
+    {
+        // not a multiple of any width, so the tails are checked as well
+        constexpr int numSamples = 1031;
+
+        std::vector<SampleType> input(numSamples), other(numSamples);
+        juce::Random random(0x616e67);
+
+        for (auto& x : input)
+            x = static_cast<SampleType>(random.nextDouble() * 6.0 - 3.0);
+
+        const auto& reference = getTable<SampleType>(getVariants()[static_cast<size_t>(Isa::scalar)]);
+        const auto& candidate = getTable<SampleType>(getVariants()[static_cast<size_t>(isa)]);
+
+        juce::String failures;
+
+        const auto compare = [&](const char* kernel, auto&& run)
+        {
+            auto expected = input;
+            auto actual = input;
+            run(reference, expected.data());
+            run(candidate, actual.data());
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                if (!(std::abs(expected[static_cast<size_t>(i)] - actual[static_cast<size_t>(i)]) <= tolerance))
+                {
+                    failures << getIsaName(isa) << " " << kernel << (std::is_same_v<SampleType, float> ? " float" : " double")
+                             << " differs at sample " << i << juce::newLine;
+                    return;
+                }
+            }
+        };
+
+        std::reverse_copy(input.begin(), input.end(), other.begin());
+
+        compare("mix", [&other](const Table<SampleType>& t, SampleType* x)
+            { t.mix(x, other.data(), numSamples, SampleType(0.2), SampleType(0.0003), SampleType(0.6), SampleType(-0.0002)); });
+        compare("limit", [](const Table<SampleType>& t, SampleType* x) { t.limit(x, numSamples, SampleType(0.9), SampleType(-0.0003), SampleType(0.89)); });
+        compare("vile", [](const Table<SampleType>& t, SampleType* x)
+            { std::vector<SampleType> distorted(numSamples + 2, SampleType(0.3)); t.vile(x, numSamples - 1, 2, SampleType(10), SampleType(0.75), distorted.data()); });
+        compare("onePole", [](const Table<SampleType>& t, SampleType* x)
+            { auto state = SampleType(0.5); t.onePole(x, numSamples, SampleType(0.7), state); });
+        compare("allPass", [&other](const Table<SampleType>& t, SampleType* x)
+            { std::vector<SampleType> feedback(numSamples); t.allPass(x, other.data(), x, feedback.data(), numSamples, SampleType(0.6), SampleType(0.48)); });
+        compare("allPass feedback", [&other](const Table<SampleType>& t, SampleType* x)
+            { std::vector<SampleType> output(numSamples); t.allPass(x, other.data(), output.data(), x, numSamples, SampleType(0.6), SampleType(0.48)); });
+
+        return failures;
+    }
+}
+
+template <typename SampleType>
+const Table<SampleType>& get()
+{
+    return getTable<SampleType>(getVariants()[static_cast<size_t>(activeIsa().load(std::memory_order_relaxed))]);
+}
+
+template const Table<float>& get<float>();
+template const Table<double>& get<double>();
+
+Isa getActiveIsa()
+{
+    return activeIsa().load(std::memory_order_relaxed);
+}
+
+bool isSupported(Isa isa)
+{
+    return juce::isPositiveAndBelow(static_cast<int>(isa), static_cast<int>(Isa::numIsas))
+        && getVariants()[static_cast<size_t>(isa)].compiled
+        && cpuHas(isa);
+}
+
+juce::String getIsaName(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::scalar:   return "scalar";
+        case Isa::sse2:     return "sse2";
+        case Isa::avx2:     return "avx2";
+        case Isa::avx512:   return "avx512";
+        case Isa::neon:     return "neon";
+        case Isa::numIsas:  break;
+    }
+
+    return {};
+}
+
+bool setActiveIsa(Isa isa)
+{
+    if (!isSupported(isa))
+        return false;
+
+    activeIsa().store(isa, std::memory_order_relaxed);
+    return true;
+}
+
+juce::String crossCheck()
+{
+    juce::String failures;
+
+    // the vector variants may fuse multiply-adds the scalar one rounds twice
+    for (int i = 1; i < static_cast<int>(Isa::numIsas); ++i)
+    {
+        const auto isa = static_cast<Isa>(i);
+
+        if (!isSupported(isa))
+            continue;
+
+        failures << checkVariant<float>(isa, 1.0e-4f) << checkVariant<double>(isa, 1.0e-9);
+    }
+
+    return failures;
+}
+}
+
+#if JUCE_UNIT_TESTS
+
+// every variant this cpu runs against the scalar one. the standalone app runs it with --unit-tests
+class SimdKernelsTest : public juce::UnitTest
+{
+public:
+    SimdKernelsTest() : juce::UnitTest("SimdKernels", "angels") {}
+
+    void runTest() override
+    {
+        beginTest("variants agree with scalar");
+
+        const auto mismatches = SimdKernels::crossCheck();
+        expect(mismatches.isEmpty(), mismatches);
+    }
+};
+
+static SimdKernelsTest simdKernelsTest;
+
+#endif
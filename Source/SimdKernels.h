@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// the block kernels of the output stage, the overlay and the reverb, built for several instruction sets
+// in the one binary. the best one the cpu has is picked the first time they're asked for,
+// the ANGELS_SIMD environment variable (scalar, sse2, avx2, avx512, neon) or setActiveIsa
+// can pin a lower one for benchmarking. every variant runs the same arithmetic in the same
+// order, so they agree to rounding, crossCheck is the proof
+namespace SimdKernels
+{
+    enum class Isa
+    {
+        scalar,
+        sse2,
+        avx2,       // with fma
+        avx512,
+        neon,
+        numIsas
+    };
+
+    // gains step per sample, the gain for sample i is start + (i + 1) * step, as the ramps
+    // in the output stage always were
+    template <typename SampleType>
+    struct Table
+    {
+        // dry = wet * wetGain + dry * dryGain, the output stage's dry/wet mix in place on the dry
+        void (*mix)(SampleType* dry, const SampleType* wet, int numSamples,
+            SampleType wetGain, SampleType wetStep, SampleType dryGain, SampleType dryStep);
+
+        // samples = samples * gain, clamped to +-ceiling. TruePeakLimiterT's gain stage
+        void (*limit)(SampleType* samples, int numSamples, SampleType gain, SampleType step, SampleType ceiling);
+
+        // the VileFilter overlay in place on interleaved frames of numChannels. distorted is
+        // scratch of numChannels + numSamples, its first numChannels the last saturated sample
+        // of each channel going in. they're the last numChannels coming out
+        void (*vile)(SampleType* samples, int numSamples, int numChannels, SampleType drive, SampleType mix, SampleType* distorted);
+
+        // samples = samples + pole * the previous output, in place. state is the output before
+        // the block going in and the last one coming out
+        void (*onePole)(SampleType* samples, int numSamples, SampleType pole, SampleType& state);
+
+        // output = delayed - input * gain, feedback = input + output * feedbackGain. output may
+        // be input, see AllPassFilterT
+        void (*allPass)(const SampleType* input, const SampleType* delayed, SampleType* output, SampleType* feedback,
+            int numSamples, SampleType gain, SampleType feedbackGain);
+    };
+
+    // the running variant's kernels, cheap enough to call per block
+    template <typename SampleType>
+    const Table<SampleType>& get();
+
+    Isa getActiveIsa();
+    bool isSupported(Isa isa);
+    juce::String getIsaName(Isa isa);
+
+    // false and no change if this cpu or build can't run it
+    bool setActiveIsa(Isa isa);
+
+    // runs every supported variant on the same noise and ramps and compares it against the
+    // scalar one, which runs the recurrences a sample at a time. empty if they all agree, otherwise which kernel on which variant didn't
+    juce::String crossCheck();
+}
@@ -0,0 +1,210 @@
+// the kernel bodies, no include guard on purpose. SimdKernels.cpp includes this once per
+// instruction set, inside that set's namespace and target region, after defining Lanes<float>
+// and Lanes<double> there: Type, width, set, load, store, add, sub, mul, div, min, max, round
+// (to nearest, ties to even) and iota (0, 1, 2 ...). the scalar tail goes through the same
+// code with one lane, so a variant's last few samples match the scalar variant exactly. the
+// tables pointing at these are built outside the regions, see SimdKernels.cpp
+
+template <typename SampleType>
+struct ScalarLanes
+{
+    using Type = SampleType;
+    static constexpr int width = 1;
+
+    static Type set(SampleType x) { return x; }
+    static Type load(const SampleType* p) { return *p; }
+    static void store(SampleType* p, Type x) { *p = x; }
+    static Type add(Type a, Type b) { return a + b; }
+    static Type sub(Type a, Type b) { return a - b; }
+    static Type mul(Type a, Type b) { return a * b; }
+    static Type div(Type a, Type b) { return a / b; }
+    static Type min(Type a, Type b) { return b < a ? b : a; }
+    static Type max(Type a, Type b) { return a < b ? b : a; }
+    static Type round(Type x) { return std::nearbyint(x); }
+    static Type iota() { return SampleType(0); }
+};
+
+// tanh as a clamped 7/6 pade, under 1e-9 off below 1.5 and 1e-4 at worst
+template <typename L, typename SampleType>
+inline typename L::Type softClipLanes(typename L::Type x)
+{
+    x = L::max(L::min(x, L::set(SampleType(5))), L::set(SampleType(-5)));
+    const auto x2 = L::mul(x, x);
+
+    const auto numerator = L::mul(x, L::add(L::set(SampleType(135135)), L::mul(x2, L::add(L::set(SampleType(17325)),
+                               L::mul(x2, L::add(L::set(SampleType(378)), x2))))));
+    const auto denominator = L::add(L::set(SampleType(135135)), L::mul(x2, L::add(L::set(SampleType(62370)),
+                                 L::mul(x2, L::add(L::set(SampleType(3150)), L::mul(x2, L::set(SampleType(28))))))));
+
+    return L::max(L::min(L::div(numerator, denominator), L::set(SampleType(1))), L::set(SampleType(-1)));
+}
+
+// sin with the argument brought into [-pi/2, pi/2] by a two part pi, then an odd taylor
+// polynomial. about 6e-8 off, the overlay only asks it for texture
+template <typename L, typename SampleType>
+inline typename L::Type sinLanes(typename L::Type x)
+{
+    const auto k = L::round(L::mul(x, L::set(SampleType(0.31830988618379067))));
+    auto r = L::sub(x, L::mul(k, L::set(SampleType(3.140625))));
+    r = L::sub(r, L::mul(k, L::set(SampleType(9.676535897932384e-4))));
+
+    const auto r2 = L::mul(r, r);
+    auto poly = L::add(L::set(SampleType(1.0 / 362880.0)), L::mul(r2, L::set(SampleType(-1.0 / 39916800.0))));
+    poly = L::add(L::set(SampleType(-1.0 / 5040.0)), L::mul(r2, poly));
+    poly = L::add(L::set(SampleType(1.0 / 120.0)), L::mul(r2, poly));
+    poly = L::add(L::set(SampleType(-1.0 / 6.0)), L::mul(r2, poly));
+    const auto s = L::add(r, L::mul(L::mul(r, r2), poly));
+
+    // odd k flips the sign. k / 2 - 1/4 is never a tie, so this rounds to floor(k / 2)
+    const auto half = L::round(L::sub(L::mul(k, L::set(SampleType(0.5))), L::set(SampleType(0.25))));
+    const auto odd = L::sub(k, L::add(half, half));
+    return L::mul(s, L::sub(L::set(SampleType(1)), L::add(odd, odd)));
+}
+
+// gains for the group starting at sample i, start + (i + 1) * step
+template <typename L, typename SampleType>
+inline typename L::Type rampLanes(int i, SampleType start, SampleType step)
+{
+    const auto index = L::add(L::iota(), L::set(static_cast<SampleType>(i + 1)));
+    return L::add(L::set(start), L::mul(index, L::set(step)));
+}
+
+template <typename L, typename SampleType>
+inline void mixGroup(SampleType* dry, const SampleType* wet, int i,
+    SampleType wetGain, SampleType wetStep, SampleType dryGain, SampleType dryStep)
+{
+    L::store(dry + i, L::add(L::mul(L::load(wet + i), rampLanes<L>(i, wetGain, wetStep)),
+                             L::mul(L::load(dry + i), rampLanes<L>(i, dryGain, dryStep))));
+}
+
+// no branch per sample, the clamp is a min and a max
+template <typename L, typename SampleType>
+inline void limitGroup(SampleType* samples, int i, SampleType gain, SampleType step, SampleType ceiling)
+{
+    const auto x = L::mul(L::load(samples + i), rampLanes<L>(i, gain, step));
+    L::store(samples + i, L::max(L::min(x, L::set(ceiling)), L::set(-ceiling)));
+}
+
+// the VileFilter overlay, the core saturation first
+template <typename L, typename SampleType>
+inline void vileDistortGroup(const SampleType* samples, SampleType* distorted, int i, SampleType drive)
+{
+    L::store(distorted + i, softClipLanes<L, SampleType>(L::mul(L::load(samples + i), L::set(drive))));
+}
+
+// then scraping modulated by the signal amplitude, and the resonance of each sample with the
+// one before on its channel, numChannels back in the interleaved stream
+template <typename L, typename SampleType>
+inline void vileGroup(SampleType* samples, const SampleType* distortedSamples, int numChannels, int i, SampleType mixAmount)
+{
+    const auto input = L::load(samples + i);
+    const auto distorted = L::load(distortedSamples + numChannels + i);
+
+    const auto scrape = L::mul(distorted, sinLanes<L, SampleType>(L::mul(input, L::set(SampleType(20)))));
+    const auto resonance = L::mul(L::add(distorted, L::load(distortedSamples + i)), L::set(SampleType(0.5)));
+
+    // blended in, then scaled down to keep the loudness in check
+    auto processed = L::add(distorted, L::add(L::mul(scrape, L::set(SampleType(0.2))), L::mul(resonance, L::set(SampleType(0.05)))));
+    processed = L::mul(processed, L::set(SampleType(0.3)));
+
+    L::store(samples + i, L::add(L::mul(input, L::set(SampleType(1) - mixAmount)), L::mul(processed, L::set(mixAmount))));
+}
+
+template <typename L, typename SampleType>
+inline void allPassGroup(const SampleType* input, const SampleType* delayed, SampleType* output, SampleType* feedback, int i,
+    SampleType gain, SampleType feedbackGain)
+{
+    const auto in = L::load(input + i);
+    const auto out = L::sub(L::load(delayed + i), L::mul(in, L::set(gain)));
+    L::store(output + i, out);
+    L::store(feedback + i, L::add(in, L::mul(out, L::set(feedbackGain))));
+}
+
+// whole groups in the variant's width, then the rest a sample at a time
+#define ANGELS_SIMD_KERNEL_LOOP(group, ...) \
+    int i = 0; \
+    for (; i + Lanes<SampleType>::width <= numSamples; i += Lanes<SampleType>::width) \
+        group<Lanes<SampleType>, SampleType>(__VA_ARGS__); \
+    for (; i < numSamples; ++i) \
+        group<ScalarLanes<SampleType>, SampleType>(__VA_ARGS__);
+
+template <typename SampleType>
+void mix(SampleType* dry, const SampleType* wet, int numSamples,
+    SampleType wetGain, SampleType wetStep, SampleType dryGain, SampleType dryStep)
+{
+    ANGELS_SIMD_KERNEL_LOOP(mixGroup, dry, wet, i, wetGain, wetStep, dryGain, dryStep)
+}
+
+template <typename SampleType>
+void limit(SampleType* samples, int numSamples, SampleType gain, SampleType step, SampleType ceiling)
+{
+    ANGELS_SIMD_KERNEL_LOOP(limitGroup, samples, i, gain, step, ceiling)
+}
+
+template <typename SampleType>
+void vile(SampleType* samples, int numSamples, int numChannels, SampleType drive, SampleType mixAmount, SampleType* distorted)
+{
+    {
+        ANGELS_SIMD_KERNEL_LOOP(vileDistortGroup, samples, distorted + numChannels, i, drive)
+    }
+
+    ANGELS_SIMD_KERNEL_LOOP(vileGroup, samples, distorted, numChannels, i, mixAmount)
+}
+
+template <typename SampleType>
+void allPass(const SampleType* input, const SampleType* delayed, SampleType* output, SampleType* feedback,
+    int numSamples, SampleType gain, SampleType feedbackGain)
+{
+    ANGELS_SIMD_KERNEL_LOOP(allPassGroup, input, delayed, output, feedback, i, gain, feedbackGain)
+}
+
+#undef ANGELS_SIMD_KERNEL_LOOP
+
+// a parallel prefix. log2(width) passes over the block leave every sample the sum of the
+// width inputs up to it, each weighted by the pole to the power of how far back it is. a group
+// then only needs the group before it, y = window + pole^width * previous lane for lane. the
+// first group's lanes would read from before the block, so its passes go a sample at a time.
+// with one lane it's the plain recurrence
+template <typename SampleType>
+void onePole(SampleType* samples, int numSamples, SampleType pole, SampleType& state)
+{
+    using L = Lanes<SampleType>;
+    constexpr int width = L::width;
+    const int whole = numSamples - numSamples % width;
+
+    if (whole > 0)
+    {
+        auto power = pole;
+
+        for (int distance = 1; distance < width; distance *= 2, power *= power)
+        {
+            // from the end back, so each group still reads the last pass's samples
+            for (int i = whole - width; i > 0; i -= width)
+                L::store(samples + i, L::add(L::load(samples + i), L::mul(L::set(power), L::load(samples + i - distance))));
+
+            for (int i = width - 1; i >= distance; --i)
+                samples[i] += power * samples[i - distance];
+        }
+
+        // pole^(lane + 1), for the state going into the first group
+        std::array<SampleType, static_cast<size_t>(width)> powers{};
+        powers[0] = pole;
+
+        for (size_t i = 1; i < powers.size(); ++i)
+            powers[i] = powers[i - 1] * pole;
+
+        auto previous = L::add(L::load(samples), L::mul(L::load(powers.data()), L::set(state)));
+        L::store(samples, previous);
+
+        for (int i = width; i < whole; i += width)
+        {
+            previous = L::add(L::load(samples + i), L::mul(L::set(powers.back()), previous));
+            L::store(samples + i, previous);
+        }
+
+        state = samples[whole - 1];
+    }
+
+    for (int i = whole; i < numSamples; ++i)
+        state = samples[i] = samples[i] + pole * state;
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ringdelay.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+// lookahead limiter on the true peak, one gain for all channels. the gain envelope is sparse,
+// a point every segmentSize samples and a ramp between them. each point is the lowest gain any
+// segment still in the lookahead needs, averaged over the lookahead so the gain slides down
+// to a peak instead of stepping, and released slowly after. a segment's peak is its samples,
+// plus the three points between each pair interpolated 4x, but only when the samples come
+// within 6 dB of the ceiling, quiet passages never run the interpolator. the ramp and a final
+// clamp to the ceiling are SimdKernels' limit kernel
+template <typename SampleType>
+class TruePeakLimiterT
+{
+public:
+    static constexpr int maxChannels = 2;
+    static constexpr int segmentSize = 16;
+    static constexpr float ceilingDb = -1.0f;
+    static constexpr double lookaheadSeconds = 0.0015;
+    static constexpr double releaseSeconds = 0.1;
+
+    void prepare(double sampleRate, int newNumChannels)
+    {
+        numChannels = juce::jlimit(1, maxChannels, newNumChannels);
+        lookaheadSegments = juce::jmax(1, juce::roundToInt(lookaheadSeconds * sampleRate / segmentSize));
+        releaseCoefficient = static_cast<SampleType>(std::exp(-segmentSize / (releaseSeconds * sampleRate)));
+
+        for (auto& line : delayLines)
+            line.prepare(getLatencySamples(), segmentSize);
+
+        required.assign(static_cast<size_t>(lookaheadSegments + 2), SampleType(1));
+        held.assign(static_cast<size_t>(lookaheadSegments), SampleType(1));
+
+        // 12 tap windowed sincs for the points a quarter, a half and three quarters past a sample
+        for (size_t phase = 0; phase < interpolationTaps.size(); ++phase)
+        {
+            const double fraction = static_cast<double>(phase + 1) / (interpolationTaps.size() + 1);
+            double sum = 0.0;
+
+            for (size_t tap = 0; tap < numTaps; ++tap)
+            {
+                const double t = static_cast<double>(tap) - (numTaps / 2 - 1) - fraction;
+                const double sinc = std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+                const double window = 0.5 * (1.0 + std::cos(juce::MathConstants<double>::pi * t / (numTaps / 2 + 0.5)));
+                interpolationTaps[phase][tap] = sinc * window;
+                sum += sinc * window;
+            }
+
+            for (auto& tap : interpolationTaps[phase])
+                tap /= sum;
+        }
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& line : delayLines)
+            line.reset();
+
+        for (auto& segment : segments)
+            segment.fill(SampleType(0));
+
+        std::fill(required.begin(), required.end(), SampleType(1));
+        std::fill(held.begin(), held.end(), SampleType(1));
+        segmentFill = 0;
+        requiredPosition = heldPosition = 0;
+        rampStart = rampEnd = SampleType(1);
+    }
+
+    // the output is the input this much later, see PluginProcessor::prepareToPlay. the
+    // lookahead plus two segments, one for the ramp and one for the interpolator's own delay
+    int getLatencySamples() const { return (lookaheadSegments + 2) * segmentSize; }
+
+    void process(juce::AudioBuffer<SampleType>& buffer)
+    {
+        const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+        const int numSamples = buffer.getNumSamples();
+        const auto& kernels = SimdKernels::get<SampleType>();
+        const auto ceiling = static_cast<SampleType>(juce::Decibels::decibelsToGain(ceilingDb));
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int count = juce::jmin(numSamples - done, segmentSize - segmentFill);
+            const auto step = (rampEnd - rampStart) / static_cast<SampleType>(segmentSize);
+
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                auto* samples = buffer.getWritePointer(channel) + done;
+                juce::FloatVectorOperations::copy(segments[static_cast<size_t>(channel)].data() + historySize + segmentFill, samples, count);
+
+                // the input goes in the line, what comes out is the lookahead behind it
+                auto& line = delayLines[static_cast<size_t>(channel)];
+                line.write(samples, count);
+                line.getReadSpan(getLatencySamples() + count, count).copyTo(samples);
+
+                kernels.limit(samples, count, rampStart + static_cast<SampleType>(segmentFill) * step, step, ceiling);
+            }
+
+            segmentFill += count;
+            done += count;
+
+            if (segmentFill == segmentSize)
+            {
+                finishSegment(channels, ceiling);
+                segmentFill = 0;
+            }
+        }
+    }
+
+    // while the host bypasses us the input still goes through the lines, so the output keeps
+    // the latency the host compensates for and picks up without a jump when we come back
+    void processBypassed(juce::AudioBuffer<SampleType>& buffer)
+    {
+        const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+        const int numSamples = buffer.getNumSamples();
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            auto* samples = buffer.getWritePointer(channel);
+            auto& line = delayLines[static_cast<size_t>(channel)];
+
+            for (int done = 0; done < numSamples;)
+            {
+                const int count = juce::jmin(numSamples - done, segmentSize);
+                line.write(samples + done, count);
+                line.getReadSpan(getLatencySamples() + count, count).copyTo(samples + done);
+                done += count;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t numTaps = 12;
+    static constexpr int historySize = static_cast<int>(numTaps) - 1;
+
+    // the segment's gain point, from its peak and the ones before it in the lookahead
+    void finishSegment(int channels, SampleType ceiling)
+    {
+        SampleType peak = SampleType(0);
+
+        for (int channel = 0; channel < channels; ++channel)
+            peak = juce::jmax(peak, getTruePeak(segments[static_cast<size_t>(channel)], ceiling));
+
+        const auto gain = peak > ceiling ? ceiling / peak : SampleType(1);
+
+        // lowest gain over the last lookahead + 2 segments, averaged over the last lookahead
+        required[requiredPosition] = gain;
+        held[heldPosition] = *std::min_element(required.begin(), required.end());
+
+        if (++requiredPosition == required.size())
+            requiredPosition = 0;
+
+        if (++heldPosition == held.size())
+            heldPosition = 0;
+
+        SampleType average = SampleType(0);
+
+        for (auto h : held)
+            average += h;
+
+        average /= static_cast<SampleType>(lookaheadSegments);
+
+        // a segment's samples go out on the ramp between the two points after it
+        rampStart = rampEnd;
+        rampEnd = juce::jmin(average, SampleType(1) - (SampleType(1) - rampEnd) * releaseCoefficient);
+
+        for (auto& segment : segments)
+            std::copy(segment.end() - historySize, segment.end(), segment.begin());
+    }
+
+    // the samples' peak, and the interpolated points' as well if they come near the ceiling.
+    // the points trail the samples by half the taps, the extra segment of latency covers that
+    SampleType getTruePeak(const std::array<SampleType, historySize + segmentSize>& segment, SampleType ceiling) const
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(segment.data(), static_cast<int>(segment.size()));
+        const auto samplePeak = juce::jmax(-range.getStart(), range.getEnd());
+
+        if (samplePeak < ceiling * SampleType(0.5))
+            return samplePeak;
+
+        SampleType peak = samplePeak;
+
+        for (const auto& taps : interpolationTaps)
+        {
+            std::array<SampleType, segmentSize> points{};
+
+            for (size_t tap = 0; tap < numTaps; ++tap)
+                for (size_t i = 0; i < points.size(); ++i)
+                    points[i] += static_cast<SampleType>(taps[tap]) * segment[i + tap];
+
+            const auto pointRange = juce::FloatVectorOperations::findMinAndMax(points.data(), segmentSize);
+            peak = juce::jmax(peak, -pointRange.getStart(), pointRange.getEnd());
+        }
+
+        return peak;
+    }
+
+    int numChannels = 2;
+    int lookaheadSegments = 1;
+    SampleType releaseCoefficient = SampleType(0);
+
+    std::array<RingDelayT<SampleType>, maxChannels> delayLines;
+
+    // each channel's segment so far, after the last historySize samples of the one before
+    std::array<std::array<SampleType, historySize + segmentSize>, maxChannels> segments{};
+    int segmentFill = 0;
+
+    std::array<std::array<double, numTaps>, 3> interpolationTaps{};
+
+    // the gains segments need, and the lowest of those in reach of each recent segment
+    std::vector<SampleType> required, held;
+    size_t requiredPosition = 0, heldPosition = 0;
+
+    SampleType rampStart = SampleType(1), rampEnd = SampleType(1);
+};
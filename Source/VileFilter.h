@@ -1,30 +1,71 @@
 #pragma once
 #include "OverlayFilter.h"
-#include <cmath>
+#include "SimdKernels.h"
 
-class VileFilter : public OverlayFilter
+// tanh-based saturation with amplitude-driven scraping and a touch of resonance from each
+// channel's last saturated sample. the arithmetic is SimdKernels' vile kernel, built for
+// whatever the cpu has. stereo goes through it interleaved, so the channels share the lanes
+// of each register in one pass
+template <typename SampleType>
+class VileFilterT : public OverlayFilterT<SampleType>
 {
 public:
-    float processSample(float inputSample) override
+    SampleType processSample(int channel, SampleType inputSample) override
     {
-        // core distortion tanh-based saturation
-        float distorted = std::tanh(inputSample * drive);
+        jassert(channel >= 0 && channel < OverlayFilterT<SampleType>::maxChannels);
+        SampleType* samples = &inputSample;
+        processChunk(&samples, 1, 1, lastDistorted.data() + channel);
+        return inputSample;
+    }
 
-        // dynamic scraping: modulation based on signal amplitude
-        float scrape = distorted * std::sin(inputSample * 20.0f); // adjust rate for texture
+    void processBlock(SampleType* const* channels, int numChannels, int numSamples) override
+    {
+        jassert(numChannels <= OverlayFilterT<SampleType>::maxChannels);
+        numChannels = juce::jmin(numChannels, OverlayFilterT<SampleType>::maxChannels);
 
-        // resonance so a feedback loop for metallic texture
-        float lastSample = 0.0f;
-        float resonance = (distorted + lastSample) * 0.5f; // feedback resonance
-        lastSample = distorted;
+        SampleType* chunk[OverlayFilterT<SampleType>::maxChannels]{};
 
-        // blend scraping and resonance into the distortion
-        float processed = distorted + 0.2f * scrape + 0.05f * resonance; // mix levels
+        for (int start = 0; start < numSamples; start += maxChunkFrames)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                chunk[channel] = channels[channel] + start;
 
-        // normalize the output to reduce loudness
-        processed *= 0.3f; // scale down amplitude
+            processChunk(chunk, numChannels, juce::jmin(maxChunkFrames, numSamples - start), lastDistorted.data());
+        }
+    }
 
-        
-        return (1.0f - mix) * inputSample + mix * processed;
+    void reset() override
+    {
+        lastDistorted.fill(SampleType(0));
     }
-};
\ No newline at end of file
+
+private:
+    static constexpr int maxChunkFrames = 256;
+    static constexpr int maxChunkSamples = OverlayFilterT<SampleType>::maxChannels * maxChunkFrames;
+
+    // state is the last saturated sample of each of numChannels
+    void processChunk(SampleType* const* channels, int numChannels, int numFrames, SampleType* state)
+    {
+        const int numSamples = numFrames * numChannels;
+        auto* samples = numChannels == 1 ? channels[0] : interleaved.data();
+
+        for (int channel = 0; channel < numChannels && numChannels > 1; ++channel)
+            for (int i = 0; i < numFrames; ++i)
+                interleaved[static_cast<size_t>(i * numChannels + channel)] = channels[channel][i];
+
+        std::copy(state, state + numChannels, distorted.begin());
+        SimdKernels::get<SampleType>().vile(samples, numSamples, numChannels,
+            static_cast<SampleType>(this->drive), static_cast<SampleType>(this->mix), distorted.data());
+        std::copy(distorted.begin() + numSamples, distorted.begin() + numSamples + numChannels, state);
+
+        for (int channel = 0; channel < numChannels && numChannels > 1; ++channel)
+            for (int i = 0; i < numFrames; ++i)
+                channels[channel][i] = interleaved[static_cast<size_t>(i * numChannels + channel)];
+    }
+
+    std::array<SampleType, OverlayFilterT<SampleType>::maxChannels> lastDistorted{};
+    std::array<SampleType, maxChunkSamples> interleaved{};
+    std::array<SampleType, OverlayFilterT<SampleType>::maxChannels + maxChunkSamples> distorted{};
+};
+
+using VileFilter = VileFilterT<float>;
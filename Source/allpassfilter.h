@@ -1,42 +1,47 @@
 ﻿#pragma once
 #include <JuceHeader.h>
+#include "ringdelay.h"
+#include "SimdKernels.h"
 
-class AllPassFilter
+// shared between the reverb's channels like the combs, see CombFilterT
+template <typename SampleType>
+class AllPassFilterT
 {
 public:
-    AllPassFilter() {}
+    AllPassFilterT() {}
 
-    void prepare(const juce::dsp::ProcessSpec& spec, float delayInMs)
+    // delayInSamples at spec.sampleRate, see CustomReverbT::prepare
+    void prepare(const juce::dsp::ProcessSpec& spec, int delayInSamples)
     {
         sampleRate = spec.sampleRate;
 
-        //delayInMs is within a valid range
-        delayInMs = juce::jlimit(1.0f, 50.0f, delayInMs);
-
-        // calculate delay in samples
-        int delayInSamples = static_cast<int>(delayInMs * (sampleRate / 1000.0));
-
         // buffer size  and the maximum delay
-        int maxDelayInSamples = static_cast<int>((50.0f * sampleRate) / 1000.0f);
-        delayLine = juce::dsp::DelayLine<float>(maxDelayInSamples);
-
-        
-        delayLine.prepare(spec);
+        int maxDelayInSamples = static_cast<int>((maxDelayMs * sampleRate) / 1000.0f);
+        delayLine.prepare(maxDelayInSamples, maxChunkSize);
 
         // clamp delayInSamples to prevent exceeding the buffer size
-        delayInSamples = juce::jlimit(0, delayLine.getMaximumDelayInSamples(), delayInSamples);
-
-        delayLine.setDelay(delayInSamples);
+        delaySamples = juce::jlimit(1, delayLine.getMaximumDelay(), delayInSamples);
     }
 
-    float processSample(float inputSample, float gain)
+    // input and output may be the same. chunks no longer than the delay, as in CombFilterT, so
+    // a chunk is one vector pass over the delayed samples
+    void processBlock(const SampleType* input, SampleType* output, int numSamples, SampleType gain)
     {
-        gain = juce::jlimit(0.0f, 0.6f, gain); // Slightly reduce max gain to prevent excessive resonance
-        float delayed = delayLine.popSample(0);
-        float output = -gain * inputSample + delayed;
-        float feedback = inputSample + (gain * output * 0.8f); // Less aggressive feedback shaping
-        delayLine.pushSample(0, feedback);
-        return output;
+        gain = juce::jlimit(SampleType(0), SampleType(maxGain), gain); // Slightly reduce max gain to prevent excessive resonance
+
+        const auto& kernels = SimdKernels::get<SampleType>();
+        const auto feedbackGain = gain * SampleType(feedbackShaping); // Less aggressive feedback shaping
+
+        std::array<SampleType, maxChunkSize> delayed, feedback;
+
+        for (int start = 0; start < numSamples;)
+        {
+            const int count = juce::jmin(numSamples - start, delaySamples, maxChunkSize);
+            delayLine.getReadSpan(delaySamples, count).copyTo(delayed.data());
+            kernels.allPass(input + start, delayed.data(), output + start, feedback.data(), count, gain, feedbackGain);
+            delayLine.write(feedback.data(), count);
+            start += count;
+        }
     }
 
     void reset()
@@ -44,7 +49,16 @@ public:
         delayLine.reset();
     }
 
+    static constexpr float maxDelayMs = 50.0f;
+    static constexpr float maxGain = 0.6f;
+    static constexpr float feedbackShaping = 0.8f;
+
 private:
+    static constexpr int maxChunkSize = 256;
+
     double sampleRate = 44100.0;
-    juce::dsp::DelayLine<float> delayLine{ 4410 }; // init with buffer size for delay line
+    RingDelayT<SampleType> delayLine;
+    int delaySamples = 1;
 };
+
+using AllPassFilter = AllPassFilterT<float>;
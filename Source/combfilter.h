@@ -1,144 +1,193 @@
 ﻿#pragma once
 #include <JuceHeader.h>
+#include "ringdelay.h"
+#include "SimdKernels.h"
 using namespace juce;
 
-class CombFilter
+// what the comb feedback absorbs per trip, a low and a high first order shelf folded into one
+// biquad. each band's loop gain becomes loopGain^(1 / multiplier), which scales that band's
+// RT60 by its multiplier. designed in CustomReverb::makeTuning, not on every sample. the
+// denominator stays as the shelves' two poles, so the comb can run each as a one-pole
+struct CombAbsorption
+{
+    static constexpr double lowCrossoverHz = 250.0;
+    static constexpr double highCrossoverHz = 2000.0;   // where the old damping lowpass sat
+
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, lowPole = 0.0f, highPole = 0.0f;
+
+    static CombAbsorption design(double loopGain, float lowMultiplier, float midMultiplier, float highMultiplier, double sampleRate)
+    {
+        // on top of the loop gain the comb already has
+        const auto bandGain = [loopGain](float multiplier)
+        {
+            return std::pow(loopGain, 1.0 / jmax(0.05, static_cast<double>(multiplier)) - 1.0);
+        };
+
+        const double mid = bandGain(midMultiplier);
+        const double low = bandGain(lowMultiplier) / mid;
+        const double high = bandGain(highMultiplier) / mid;
+
+        // bilinear transform of (b1 s + b0) / (a1 s + a0), prewarped to the corner.
+        // returns the normalised b0, b1 and a1
+        const auto shelf = [sampleRate](double cornerHz, double sb1, double sb0, double sa1, double sa0)
+        {
+            const double k = 1.0 / std::tan(MathConstants<double>::pi * jmin(cornerHz, 0.45 * sampleRate) / sampleRate);
+            const double norm = sa1 * k + sa0;
+            return std::array<double, 3>{ (sb1 * k + sb0) / norm, (sb0 - sb1 * k) / norm, (sa0 - sa1 * k) / norm };
+        };
+
+        // low shelf: low at dc, 1 at nyquist. high shelf: 1 at dc, high at nyquist
+        const auto lowShelf = shelf(lowCrossoverHz, 1.0, std::sqrt(low), 1.0, 1.0 / std::sqrt(low));
+        const auto highShelf = shelf(highCrossoverHz, high, std::sqrt(high), 1.0, std::sqrt(high));
+
+        CombAbsorption c;
+        c.b0 = static_cast<float>(mid * lowShelf[0] * highShelf[0]);
+        c.b1 = static_cast<float>(mid * (lowShelf[0] * highShelf[1] + lowShelf[1] * highShelf[0]));
+        c.b2 = static_cast<float>(mid * lowShelf[1] * highShelf[1]);
+        c.lowPole = static_cast<float>(-lowShelf[2]);
+        c.highPole = static_cast<float>(-highShelf[2]);
+        return c;
+    }
+};
+
+// SampleType is what the delay lines, filter and feedback state are kept in. CustomReverbT
+// picks it, see DSPWrapper::Precision. the reverb shares each comb between its channels, the
+// stream through it is left and right samples taking turns, see CustomReverbT::processLateBlock
+template <typename SampleType>
+class CombFilterT
 {
 public:
-    CombFilter() {}
+    CombFilterT() {}
 
-    void prepare(const dsp::ProcessSpec& spec, float delayInMs)
+    void prepare(const dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate;
-        delayInMs = jlimit(1.0f, 50.0f, delayInMs);
-
-        int maxDecaySamples = static_cast<int>((150.0f * sampleRate) / 1000.0f);
-        int maxSpatialSamples = static_cast<int>((600.0f * sampleRate) / 1000.0f);
 
-        decayDelayLine = dsp::DelayLine<float>(maxDecaySamples);
-        spatialDelayLine = dsp::DelayLine<float>(maxSpatialSamples);
-        widthDelayLine = dsp::DelayLine<float>(1024);
+        int maxDecaySamples = static_cast<int>((maxDecayDelayMs * sampleRate) / 1000.0f);
 
-        decayDelayLine.prepare(spec);
-        spatialDelayLine.prepare(spec);
-        widthDelayLine.prepare(spec);
+        // one past the longest delay for the interpolation, a chunk is never longer than the delay
+        decayDelayLine.prepare(maxDecaySamples + 1, maxChunkSize);
 
        
-        highPassDecayFilter.setCoefficients(juce::IIRCoefficients::makeHighPass(sampleRate, decayCutoffFrequency, 0.707f));
+        highPassDecayFilter.coefficients = dsp::IIR::Coefficients<SampleType>::makeHighPass(sampleRate, decayCutoffFrequency, 0.707f);
 
         reset();
     }
-    float processSample(float inputSample, float feedbackGain, float sizeFactor,
-        bool isLeftChannel, float width, float mix)
+
+    // numSamples of the shared stream, mono in and mono out. early is the shared early
+    // reflections output, see EarlyReflectionsT. the loop runs in chunks no longer than the
+    // delay, so everything a chunk reads back was written before it started and none of its
+    // samples feed each other. the feedback path is whole chunk vector passes, the absorption's
+    // poles a parallel prefix each, see SimdKernels::Table::onePole
+    void processBlock(const SampleType* input, const SampleType* early, SampleType* output, int numSamples,
+        SampleType feedbackGain, SampleType mix)
     {
-        if (mix < 0.001f)
-            return inputSample;
+        if (mix < SampleType(0.001))
+        {
+            FloatVectorOperations::copy(output, input, numSamples);
+            return;
+        }
 
-        mix = juce::jlimit(0.0f, 1.0f, mix);
-        float drySignal = inputSample;
+        mix = juce::jlimit(SampleType(0), SampleType(1), mix);
 
-        
-        float decayInput = highPassDecayFilter.processSingleSampleRaw(inputSample);
+        const int wholeDelay = static_cast<int>(decayDelay);
+        const auto fraction = static_cast<SampleType>(decayDelay - static_cast<float>(wholeDelay));
 
-        
-        float delayedFeedback = decayDelayLine.popSample(0);
-        constexpr float combCutoff = 2000.0f;
-        float alpha = combCutoff / (combCutoff + sampleRate / (2.0f * juce::MathConstants<float>::pi));
-        delayedFeedback = alpha * delayedFeedback + (1.0f - alpha) * lastDecaySample;
-        delayedFeedback *= 0.9995f;
-        lastDecaySample = delayedFeedback;
+        const auto& kernels = SimdKernels::get<SampleType>();
+        const auto tailGain = feedbackGain > SampleType(0)
+            ? feedbackGain * SampleType(dampingGain) * SampleType(feedbackScale)
+            : SampleType(0);
 
-       
-        if (std::abs(sizeFactor - lastSizeFactor) > 0.001f)
+        // delayed keeps the two samples before the chunk in front for the absorption's zeros
+        std::array<SampleType, maxChunkSize + 2> delayed;
+        std::array<SampleType, maxChunkSize> further, absorbed, decaySignals;
+
+        for (int start = 0; start < numSamples;)
         {
-            float sizeMapped = juce::jmap(sizeFactor, 0.0f, 1.0f, 0.5f, 2.5f);
-            int maxDelaySamples = decayDelayLine.getMaximumDelayInSamples();
-            int newDelay = juce::jlimit(1, maxDelaySamples,
-                static_cast<int>(sizeMapped * sampleRate / 1000.0f));
-            decayDelayLine.setDelay(newDelay);
-            lastSizeFactor = sizeFactor;
+            const int count = jmin(numSamples - start, wholeDelay, maxChunkSize);
+
+            // linear between the samples either side of the fractional delay
+            delayed[0] = absorptionHistory[0];
+            delayed[1] = absorptionHistory[1];
+            SampleType* const current = delayed.data() + 2;
+            decayDelayLine.getReadSpan(wholeDelay, count).copyTo(current);
+            decayDelayLine.getReadSpan(wholeDelay + 1, count).copyTo(further.data());
+            FloatVectorOperations::multiply(current, SampleType(1) - fraction, count);
+            FloatVectorOperations::addWithMultiply(current, further.data(), fraction, count);
+            absorptionHistory = { current[count - 2], current[count - 1] };
+
+            // per band absorption, the zeros then each pole
+            FloatVectorOperations::multiply(absorbed.data(), current, absorptionB0, count);
+            FloatVectorOperations::addWithMultiply(absorbed.data(), current - 1, absorptionB1, count);
+            FloatVectorOperations::addWithMultiply(absorbed.data(), current - 2, absorptionB2, count);
+            kernels.onePole(absorbed.data(), count, absorptionLowPole, lowPoleState);
+            kernels.onePole(absorbed.data(), count, absorptionHighPole, highPoleState);
+
+            // the highpass runs across the chunk first, it doesn't depend on the loop
+            for (int i = 0; i < count; ++i)
+                decaySignals[static_cast<size_t>(i)] = highPassDecayFilter.processSample(input[start + i]);
+
+            FloatVectorOperations::multiply(decaySignals.data(), SampleType(0.1), count);
+            FloatVectorOperations::addWithMultiply(decaySignals.data(), absorbed.data(), tailGain, count);
+            FloatVectorOperations::addWithMultiply(decaySignals.data(), early + start, SampleType(0.2), count);
+
+            // the reflections blend in again on the way out, the channels' width is the
+            // reverb's output stage
+            constexpr SampleType spatialBlendFactor = SampleType(0.20);
+            FloatVectorOperations::multiply(output + start, input + start, SampleType(1) - mix, count);
+            FloatVectorOperations::addWithMultiply(output + start, decaySignals.data(), mix, count);
+            FloatVectorOperations::addWithMultiply(output + start, early + start, mix * spatialBlendFactor, count);
+
+            decayDelayLine.write(decaySignals.data(), count);
+            start += count;
         }
+    }
 
-        
-        float decayTail = (feedbackGain > 0.0f)
-            ? feedbackGain * delayedFeedback * 1.1f
-            : 0.0f;
-        
-        float decaySignal = decayInput * 0.1f + decayTail;
-
-        
-        float spatialEcho = spatialDelayLine.popSample(0);
-        
-        float spatialSignal = decayInput + 0.45f * spatialEcho;
-        spatialSignal *= 0.99f;
-        spatialDelayLine.pushSample(0, spatialSignal);
-        spatialEcho = (spatialEcho + lastSpatialSample) * 0.5f;
-        lastSpatialSample = spatialEcho;
-
-       
-        decaySignal += 0.2f * spatialEcho;
-        decayDelayLine.pushSample(0, decaySignal);
-
-        
-        constexpr float maxWidthDelayTime = 0.02f;
-        float delaySamples = width * (maxWidthDelayTime * sampleRate);
-        widthDelayLine.setDelay(delaySamples);
-        float delayedRight = widthDelayLine.popSample(0);
-        widthDelayLine.pushSample(0, decaySignal);
-
-        float leftOutput = decaySignal;
-        float rightOutput = delayedRight;
-        constexpr float spatialBlendFactor = 0.20f;
-        leftOutput += spatialBlendFactor * spatialEcho;
-        rightOutput += spatialBlendFactor * spatialEcho;
-        constexpr float rightCorrectionFactor = 0.97f;
-        rightOutput *= rightCorrectionFactor;
-
-        float wetOutput = isLeftChannel ? leftOutput : rightOutput;
-
-       
-        float out = (1.0f - mix) * drySignal + mix * wetOutput;
-        return out;
+    // delay time in samples, worked out ahead of time by CustomReverb::makeTuning
+    void setDelay(float decayDelaySamples)
+    {
+        decayDelay = jlimit(1.0f, static_cast<float>(decayDelayLine.getMaximumDelay() - 1), decayDelaySamples);
     }
 
-    void setSize(float newSize, float baseDelayMs)
+    void setAbsorption(const CombAbsorption& absorption)
     {
-        float spatialMultiplier = jmap(newSize, 0.0f, 1.0f, 1.0f, 15.0f);
-        float spatialDelayMs = baseDelayMs * spatialMultiplier;
-        int spatialSamples = static_cast<int>((spatialDelayMs * sampleRate) / 1000.0f);
-        spatialDelayLine.setDelay(jlimit(1.0f,
-            static_cast<float>(spatialDelayLine.getMaximumDelayInSamples()),
-            static_cast<float>(spatialSamples)));
-
-        float decayMultiplier = jmap(newSize, 0.0f, 1.0f, 1.0f, 1.5f);
-        float decayDelayMs = baseDelayMs * decayMultiplier;
-        int decaySamples = static_cast<int>((decayDelayMs * sampleRate) / 1000.0f);
-        decayDelayLine.setDelay(jlimit(1.0f,
-            static_cast<float>(decayDelayLine.getMaximumDelayInSamples()),
-            static_cast<float>(decaySamples)));
+        absorptionB0 = static_cast<SampleType>(absorption.b0);
+        absorptionB1 = static_cast<SampleType>(absorption.b1);
+        absorptionB2 = static_cast<SampleType>(absorption.b2);
+        absorptionLowPole = static_cast<SampleType>(absorption.lowPole);
+        absorptionHighPole = static_cast<SampleType>(absorption.highPole);
     }
 
+    // loop gains, per trip round each delay line. CustomReverb::getTailSeconds uses them
+    static constexpr float feedbackScale = 1.1f;
+    static constexpr float dampingGain = 0.9995f;
+
+    static constexpr float maxDecayDelayMs = 150.0f;
+
     void reset()
     {
         decayDelayLine.reset();
-        spatialDelayLine.reset();
-        widthDelayLine.reset();
-        lastDecaySample = 0.0f;
-        lastSpatialSample = 0.0f;
+        highPassDecayFilter.reset();
+        absorptionHistory = {};
+        lowPoleState = highPoleState = SampleType(0);
     }
 
 private:
+    static constexpr int maxChunkSize = 256;
+
     double sampleRate = 44100.0;
-    float lastDecaySample = 0.0f;
-    float lastSpatialSample = 0.0f;
+    float decayDelay = 1.0f;
+
+    SampleType absorptionB0 = SampleType(1), absorptionB1 = SampleType(0), absorptionB2 = SampleType(0);
+    SampleType absorptionLowPole = SampleType(0), absorptionHighPole = SampleType(0);
+    std::array<SampleType, 2> absorptionHistory{};     // the last two delayed samples, oldest first
+    SampleType lowPoleState = SampleType(0), highPoleState = SampleType(0);
 
     
-    float lastSizeFactor = -1.0f;  
-    
-    juce::IIRFilter highPassDecayFilter;
+    dsp::IIR::Filter<SampleType> highPassDecayFilter;
     float decayCutoffFrequency = 120.0f; 
 
-    dsp::DelayLine<float> decayDelayLine{ 44100 };
-    dsp::DelayLine<float> spatialDelayLine{ 44100 };
-    dsp::DelayLine<float> widthDelayLine{ 1024 };
-};
\ No newline at end of file
+    RingDelayT<SampleType> decayDelayLine;
+};
+
+using CombFilter = CombFilterT<float>;
\ No newline at end of file
@@ -1,102 +1,164 @@
 ﻿#pragma once
 #include "combfilter.h"
 #include "allpassfilter.h"
+#include "earlyreflections.h"
+#include "halfbandfilter.h"
+#include "reverbtopology.h"
 #include <array>
 #include <JuceHeader.h>
 #include "FrequencyAnalyzer.h"  
 
-class CustomReverb
+// decay time multipliers per band, 1 leaves a band at the network's own decay.
+// the crossovers are in CombAbsorption
+struct DecayBands
+{
+    float low = 1.0f;
+    float mid = 1.0f;
+    float high = 0.5f;
+};
+
+// everything the network derives from size, decay and the band decays, computed off the audio thread where
+// possible (see DSPWrapper::postTuning) and glided between on the audio thread
+template <size_t NumCombs>
+struct ReverbTuningT
+{
+    static constexpr size_t numCombs = NumCombs;
+
+    std::array<float, numCombs> combDecayDelays{};      // in samples
+    std::array<EarlyReflectionTaps, 2> earlyTaps;        // left, right
+    CombAbsorption absorption;
+    float inputGain = 1.0f;
+    double tailSeconds = 0.0;    // -60 dB ring-down time, see CustomReverb::getTailSeconds
+    double networkRate = 0.0;    // the comb delays are in samples at this rate, see getDecimationFactor
+
+    // the settings it was made for
+    float size = -1.0f;
+    float decay = -1.0f;
+    DecayBands bands;
+    double sampleRate = 0.0;
+};
+
+using ReverbTuning = ReverbTuningT<StandardTopology::combDelaysMs.size()>;
+
+// SampleType is the precision the whole network runs and keeps its state in, Topology the
+// combs and allpasses it has, see reverbtopology.h
+template <typename SampleType, typename Topology = StandardTopology>
+class CustomReverbT
 {
 public:
-    
-    CustomReverb(FrequencyAnalyzer* analyzer = nullptr)
+    static constexpr size_t numCombs = Topology::combDelaysMs.size();
+    static constexpr size_t numAllPasses = Topology::allPassDelaysMs.size();
+    using Tuning = ReverbTuningT<numCombs>;
+
+    CustomReverbT(FrequencyAnalyzer* analyzer = nullptr)
         : frequencyAnalyzer(analyzer), fft(10)
     {
         
         demoTestSignal = false;
     }
 
-    void prepare(double sampleRate, int numChannels)
+    // limitNetworkRate runs the combs and allpasses at 48k or below, see getDecimationFactor
+    void prepare(double sampleRate, int numChannels, int maxBlockSize = 512, bool limitNetworkRate = true)
     {
         this->sampleRate = sampleRate;
 
+        const int decimation = getDecimationFactor(sampleRate, limitNetworkRate);
+        networkRate = sampleRate / decimation;
+
+        for (auto& cascade : downCascades)
+            cascade.prepare(juce::roundToInt(std::log2(decimation)));
+        for (auto& cascade : upCascades)
+            cascade.prepare(juce::roundToInt(std::log2(decimation)));
+
+        for (auto& queue : wetQueues)
+            queue.fill(SampleType(0));
+        wetQueueIndex = 0;
+
         instanceDecayBuffer.resize(512, 0.0f);
+        monoBuffer.assign(static_cast<size_t>(juce::jmax(1, maxBlockSize)), SampleType(0));
+        earlyBuffer.setSize(2, juce::jmax(1, maxBlockSize));
+        earlyBuffer.clear();
+        lateBuffer.setSize(2, juce::jmax(1, maxBlockSize));
+        lateBuffer.clear();
+        earlyReflections.prepare(sampleRate, 2, juce::jmax(1, maxBlockSize));
+        widthDelayLine.prepare(static_cast<int>(maxWidthDelayMs * sampleRate / 1000.0) + 1, maxNetworkFrames);
 
 
+        // the late network only ever sees the network rate
         juce::dsp::ProcessSpec spec;
-        spec.sampleRate = sampleRate;
+        spec.sampleRate = networkRate;
         spec.numChannels = static_cast<juce::uint32>(numChannels);
-        spec.maximumBlockSize = 512;
+        spec.maximumBlockSize = static_cast<juce::uint32>(juce::jmax(1, maxBlockSize / decimation + 1));
 
 
 
         sizeParameter = juce::jlimit(0.0f, 1.0f, sizeParameter);
+        hasTuning = false;
+        tuningRampRemaining = 0;
 
         for (size_t i = 0; i < combFilters.size(); ++i)
-        {
-            float baseDelayInMs = combDelaysMs[i];
-            float scaledDelayInMs = juce::jmap(sizeParameter, 0.5f, 2.0f) * baseDelayInMs;
-            combFilters[i].prepare(spec, scaledDelayInMs);
-        }
+            combFilters[i].prepare(spec);
+
+        const auto allPassLengths = getAllPassLengths(sizeParameter, networkRate);
 
         for (size_t i = 0; i < allPassFilters.size(); ++i)
-        {
-            float baseDelayInMs = allPassDelaysMs[i];
-            float scaledDelayInMs = juce::jmap(sizeParameter, 0.5f, 2.0f) * baseDelayInMs;
-            allPassFilters[i].prepare(spec, scaledDelayInMs);
-        }
+            allPassFilters[i].prepare(spec, allPassLengths[i]);
+
+        // whatever stages were asked for, without a fade
+        combWeights.fill(SampleType(0));
+        allPassWeights.fill(SampleType(0));
+        std::fill(combWeights.begin(), combWeights.begin() + activeCombs, SampleType(1));
+        std::fill(allPassWeights.begin(), allPassWeights.begin() + activeAllPasses, SampleType(1));
+        combSumGain = combSumGainTarget;
+        finishStageFade();
     }
 
-    float CustomReverb::processSample(float inputSample, float decay, bool isLeftChannel, float mix, int sampleIndex)
+    // numSamples of the late network's stream at the network rate. the combs and allpasses are
+    // shared between the channels, so the stream is left and right samples taking turns. late
+    // is the input after the pre-delay, wet gets the combs and allpasses without the dry
+    // signal. late and early are scaled in place. at most maxNetworkSamples
+    void processLateBlock(SampleType* late, SampleType* early, SampleType* wet, int numSamples, float decay, float mix)
     {
-        if (mix < 0.001f)
-            return inputSample;
-
-        float drySignal = inputSample;
+        jassert(numSamples <= maxNetworkSamples);
 
-        
-        float noiseFilterFreq = juce::jmap(decay, 0.0f, 1.0f, 20.0f, 100.0f);
-        float qFactor = 1.2f;
-        juce::IIRFilter highPassFilter;
-        highPassFilter.setCoefficients(juce::IIRCoefficients::makeHighPass(44100.0f, noiseFilterFreq, qFactor));
-        float filteredInput = highPassFilter.processSingleSampleRaw(inputSample);
-
-        
-        float decayEffect = juce::jmap(decay, 0.0f, 1.0f, 0.2f, 0.75f);
-        float decayInput = filteredInput * decayEffect;
+        // the noise highpass is only a gain, precomputed in makeTuning. decay and size scale the
+        // input, and the reflections go into the combs at the same level as the direct input
+        const auto decayEffect = static_cast<SampleType>(juce::jmap(decay, 0.0f, 1.0f, 0.2f, 0.75f));
+        const auto adjustedSize = static_cast<SampleType>(juce::jmap(sizeParameter, 0.0f, 1.0f, 0.7f, 1.3f));
+        const auto inputGain = static_cast<SampleType>(currentTuning.inputGain) * decayEffect * adjustedSize;
+        juce::FloatVectorOperations::multiply(late, inputGain, numSamples);
+        juce::FloatVectorOperations::multiply(early, inputGain, numSamples);
 
-       
-        float adjustedSize = juce::jmap(sizeParameter, 0.0f, 1.0f, 0.7f, 1.3f);
-        decayInput *= adjustedSize;
+        // idle stages past numRunningCombs / numRunningAllPasses cost nothing, the weights
+        // are 1 outside a stage fade
+        juce::FloatVectorOperations::clear(wet, numSamples);
 
-        
-        float combSum = 0.0f;
-        for (size_t i = 0; i < combFilters.size(); ++i)
+        for (size_t i = 0; i < numRunningCombs; ++i)
         {
-            
-            combSum += combFilters[i].processSample(decayInput, 0.3f, sizeParameter, isLeftChannel, widthParameter, mix);
+            combFilters[i].processBlock(late, early, stageOutput.data(), numSamples, SampleType(combFeedback), static_cast<SampleType>(mix));
+
+            for (int n = 0; n < numSamples; ++n)
+                wet[n] += getStageWeight(combWeights[i], combWeightSteps[i], n) * stageOutput[static_cast<size_t>(n)];
         }
 
-        
-        combSum = juce::jlimit(-0.5f, 0.5f, combSum);
+        for (int n = 0; n < numSamples; ++n)
+            wet[n] = juce::jlimit(SampleType(-0.5), SampleType(0.5), wet[n] * getStageWeight(combSumGain, combSumGainStep, n));
 
-       
-        float allPassOut = combSum;
-        for (size_t i = 0; i < allPassFilters.size(); ++i)
+        for (size_t i = 0; i < numRunningAllPasses; ++i)
         {
-            allPassOut = allPassFilters[i].processSample(allPassOut, 0.6f);
-        }
+            allPassFilters[i].processBlock(wet, stageOutput.data(), numSamples, SampleType(allPassGain));
 
-        
+            for (int n = 0; n < numSamples; ++n)
+                wet[n] += getStageWeight(allPassWeights[i], allPassWeightSteps[i], n) * (stageOutput[static_cast<size_t>(n)] - wet[n]);
+        }
 
-        
-        allPassOut *= juce::jmap(mix, 0.0f, 1.0f, 0.85f, 1.15f);
+        juce::FloatVectorOperations::multiply(wet, static_cast<SampleType>(juce::jmap(mix, 0.0f, 1.0f, 0.85f, 1.15f)), numSamples);
 
-        float out = drySignal + allPassOut;
-        return out;
+        if (stageFadeRemaining > 0)
+            advanceStageFade(numSamples / 2);
     }
 
-    void processBlock(juce::AudioBuffer<float>& buffer, float decay, float mix)
+    void processBlock(juce::AudioBuffer<SampleType>& buffer, float decay, float mix)
     {
         const int numChannels = buffer.getNumChannels();
         const int numSamples = buffer.getNumSamples();
@@ -110,6 +172,8 @@ public:
             std::fill(instanceDecayBuffer.begin(), instanceDecayBuffer.end(), 0.0f);
         }
 
+        advanceTuning(numSamples);
+
         if (numChannels < 2)
             return;
 
@@ -120,8 +184,25 @@ public:
 
 
 
-       
-        std::vector<float> monoBuffer(numSamples, 0.0f);
+        // preallocated in prepare, only grows if the host breaks its block size
+        if (monoBuffer.size() < static_cast<size_t>(numSamples))
+            monoBuffer.resize(static_cast<size_t>(numSamples), SampleType(0));
+
+        // host broke its block size, grow once rather than drop the reflections
+        if (earlyBuffer.getNumSamples() < numSamples)
+        {
+            earlyBuffer.setSize(2, numSamples, false, false, true);
+            lateBuffer.setSize(2, numSamples, false, false, true);
+        }
+
+        // the whole block of reflections and pre-delayed input up front, the per-sample loop
+        // just reads them
+        auto* earlyLeft = earlyBuffer.getWritePointer(0);
+        auto* earlyRight = earlyBuffer.getWritePointer(1);
+        auto* lateLeft = lateBuffer.getWritePointer(0);
+        auto* lateRight = lateBuffer.getWritePointer(1);
+        earlyReflections.process(0, leftChannel, earlyLeft, lateLeft, numSamples);
+        earlyReflections.process(1, rightChannel, earlyRight, lateRight, numSamples);
 
         if (demoTestSignal)
         {
@@ -129,7 +210,7 @@ public:
             const float freq = 440.0f;
             for (int sample = 0; sample < numSamples; ++sample)
             {
-                monoBuffer[sample] = 0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * freq * sample / sampleRate);
+                monoBuffer[sample] = static_cast<SampleType>(0.5f * std::sin(2.0f * juce::MathConstants<float>::pi * freq * sample / sampleRate));
                 leftChannel[sample] = monoBuffer[sample];
                 rightChannel[sample] = monoBuffer[sample];
             }
@@ -137,16 +218,64 @@ public:
         else
         {
             
-            for (int sample = 0; sample < numSamples; ++sample)
+            // the late network's output replaces its input in lateLeft and lateRight. it
+            // doesn't run at all with the mix right down
+            if (mix < 0.001f)
+            {
+                juce::FloatVectorOperations::clear(lateLeft, numSamples);
+                juce::FloatVectorOperations::clear(lateRight, numSamples);
+            }
+            else if (networkRate < sampleRate)
+            {
+                processDecimated(lateLeft, lateRight, earlyLeft, earlyRight, numSamples, decay, mix);
+            }
+            else
+            {
+                for (int start = 0; start < numSamples; start += maxNetworkFrames)
+                {
+                    const int numFrames = juce::jmin(maxNetworkFrames, numSamples - start);
+                    interleave(networkLate.data(), lateLeft + start, lateRight + start, numFrames);
+                    interleave(networkEarly.data(), earlyLeft + start, earlyRight + start, numFrames);
+                    processLateBlock(networkLate.data(), networkEarly.data(), networkWet.data(), 2 * numFrames, decay, mix);
+
+                    for (int i = 0; i < numFrames; ++i)
+                    {
+                        lateLeft[start + i] = networkWet[static_cast<size_t>(2 * i)];
+                        lateRight[start + i] = networkWet[static_cast<size_t>(2 * i + 1)];
+                    }
+                }
+            }
+
+            // the stereo width, once for the whole reverb. the wet signal's side scales with the
+            // width, mono at 0, and the late mid comes back into it a short delay later to pull
+            // the channels apart. the delay grows with the width too
+            const auto width = static_cast<SampleType>(widthParameter);
+            const int widthDelay = juce::jlimit(1, widthDelayLine.getMaximumDelay(),
+                static_cast<int>(widthParameter * maxWidthDelayMs * sampleRate / 1000.0));
+
+            for (int start = 0; start < numSamples; start += maxNetworkFrames)
             {
-                float leftWet = processSample(leftChannel[sample], decay, true, mix, sample);
-                float rightWet = processSample(rightChannel[sample], decay, false, mix, sample);
-                float monoSignal = (leftWet + rightWet) * 0.5f;
-
-                
-                leftChannel[sample] = juce::jmap(widthParameter, 0.0f, 1.0f, monoSignal, leftWet);
-                rightChannel[sample] = juce::jmap(widthParameter, 0.0f, 1.0f, monoSignal, rightWet);
-                monoBuffer[sample] = monoSignal;
+                const int count = juce::jmin(maxNetworkFrames, numSamples - start);
+
+                for (int i = 0; i < count; ++i)
+                    delayedMid[static_cast<size_t>(i)] = (lateLeft[start + i] + lateRight[start + i]) * SampleType(0.5);
+
+                widthDelayLine.write(delayedMid.data(), count);
+                widthDelayLine.getReadSpan(widthDelay + count, count).copyTo(delayedMid.data());
+
+                for (int i = 0; i < count; ++i)
+                {
+                    const int sample = start + i;
+                    const SampleType leftWet = leftChannel[sample] + lateLeft[sample];
+                    const SampleType rightWet = rightChannel[sample] + lateRight[sample];
+                    const SampleType mid = (leftWet + rightWet) * SampleType(0.5);
+                    const SampleType side = (leftWet - rightWet) * SampleType(0.5)
+                                          + SampleType(widthDecorrelation) * delayedMid[static_cast<size_t>(i)];
+
+                    leftChannel[sample] = mid + width * side;
+                    rightChannel[sample] = mid - width * side;
+                    monoBuffer[sample] = mid;
+                }
             }
         }
 
@@ -156,8 +285,178 @@ public:
     void setSize(float newSize)
     {
         sizeParameter = juce::jlimit(0.4f, 2.8f, newSize);
+    }
+
+    // the delay times and input gain for a size/decay pair. pure function of its
+    // arguments, so it can run on any thread
+    static Tuning makeTuning(float size, float decay, double sampleRate, DecayBands bands = {}, bool limitNetworkRate = true)
+    {
+        Tuning tuning;
+        tuning.size = size;
+        tuning.decay = decay;
+        tuning.bands = bands;
+        tuning.sampleRate = sampleRate;
+        tuning.networkRate = sampleRate / getDecimationFactor(sampleRate, limitNetworkRate);
+        tuning.absorption = CombAbsorption::design(getCombLoopGain(), bands.low, bands.mid, bands.high, tuning.networkRate);
+
+        const float clampedSize = juce::jlimit(0.4f, 2.8f, size);
+        const float decayMultiplier = juce::jmap(clampedSize, 0.0f, 1.0f, 1.0f, 1.5f);
+        // mutually prime at the target, the glide between two tunings passes through whatever
+        const auto baseCombs = TopologyDelays<Topology>::forRate(tuning.networkRate).combs;
+        std::array<int, numCombs> combLengths{};
+
+        for (size_t i = 0; i < numCombs; ++i)
+            combLengths[i] = static_cast<int>(std::floor(static_cast<float>(baseCombs[i]) * decayMultiplier));
+
+        combLengths = makeMutuallyPrime(combLengths);
+
+        for (size_t i = 0; i < numCombs; ++i)
+            tuning.combDecayDelays[i] = static_cast<float>(combLengths[i]);
+
+        for (size_t channel = 0; channel < tuning.earlyTaps.size(); ++channel)
+            tuning.earlyTaps[channel] = EarlyReflectionTaps::forRoom(size, sampleRate, static_cast<int>(channel));
+
+        // a highpass rebuilt for every sample never gets past its b0 term, which is
+        // all that's left of it here. 44.1k as in the original filter setup
+        const float noiseFilterFreq = juce::jmap(decay, 0.0f, 1.0f, 20.0f, 100.0f);
+        tuning.inputGain = juce::IIRCoefficients::makeHighPass(44100.0, noiseFilterFreq, 1.2).coefficients[0];
+
+        tuning.tailSeconds = getTailSeconds(tuning);
+        return tuning;
+    }
+
+    // roughly how long the network takes to ring down by 60 dB once the input stops, an
+    // estimate for the host rather than a measurement. a loop with gain g round a delay of d
+    // seconds takes 3 * d / -log10(g) to lose 60 dB. the early reflections feed the decay comb
+    // which feeds the allpasses, so the last reflection and the slowest loop of each stage add
+    // up. decay only scales the input, it doesn't change how long anything rings. the band
+    // multipliers scale the comb ring time, the slowest band counts
+    static double getTailSeconds(const Tuning& tuning)
+    {
+        if (tuning.sampleRate <= 0.0 || tuning.networkRate <= 0.0)
+            return 0.0;
+
+        const auto ringTime = [](double delaySeconds, double loopGain)
+        {
+            return loopGain > 0.0 && loopGain < 1.0 ? 3.0 * delaySeconds / -std::log10(loopGain) : 0.0;
+        };
+
+        // the comb and allpass lengths are in the interleaved stream, left and right taking
+        // turns, so each channel goes round a loop in half the time. capped as the lines are
+        const double streamRate = 2.0 * tuning.networkRate;
+        const auto loopSeconds = [&](double length, double maxMs)
+        {
+            return juce::jmin(length, maxMs * tuning.networkRate / 1000.0) / streamRate;
+        };
+
+        using Comb = CombFilterT<SampleType>;
+
+        const float slowestBand = juce::jmax(tuning.bands.low, tuning.bands.mid, tuning.bands.high);
+        const double decayLoopGain = std::pow(getCombLoopGain(), 1.0 / juce::jmax(0.05, static_cast<double>(slowestBand)));
+        const double allPassLoopGain = static_cast<double>(allPassGain) * AllPassFilterT<SampleType>::feedbackShaping;
+
+        double longestDecay = 0.0, longestAllPass = 0.0, lastReflection = 0.0;
+
+        for (auto length : tuning.combDecayDelays)
+            longestDecay = juce::jmax(longestDecay, loopSeconds(length, Comb::maxDecayDelayMs));
+
+        // the lengths prepare gives the allpasses at this size
+        for (auto length : getAllPassLengths(tuning.size, tuning.networkRate))
+            longestAllPass = juce::jmax(longestAllPass, loopSeconds(length, AllPassFilterT<SampleType>::maxDelayMs));
+
+        for (const auto& taps : tuning.earlyTaps)
+            lastReflection = juce::jmax(lastReflection, static_cast<double>(taps.getLongestDelay()) / tuning.sampleRate);
+
+        return lastReflection
+             + ringTime(longestDecay, decayLoopGain)
+             + ringTime(longestAllPass, allPassLoopGain);
+    }
+
+    // the allpass lengths in the stream for a size, set in prepare. the base lengths come from
+    // the compiler at the usual rates, scaling them by the size can make two share a factor again
+    static std::array<int, numAllPasses> getAllPassLengths(float size, double rate)
+    {
+        const float sizeScale = juce::jmap(juce::jlimit(0.0f, 1.0f, size), 0.5f, 2.0f);
+        const auto baseAllPasses = TopologyDelays<Topology>::forRate(rate).allPasses;
+        std::array<int, numAllPasses> lengths{};
+
+        for (size_t i = 0; i < numAllPasses; ++i)
+            lengths[i] = juce::roundToInt(static_cast<float>(baseAllPasses[i]) * sizeScale);
+
+        return makeMutuallyPrime(lengths);
+    }
+
+    // glides the delay times to the new tuning over rampLengthSamples, the first
+    // tuning after prepare is applied straight away
+    void setTuning(const Tuning& newTuning, int rampLengthSamples)
+    {
+        targetTuning = newTuning;
+
+        if (!hasTuning || rampLengthSamples <= 0)
+        {
+            currentTuning = newTuning;
+            tuningRampRemaining = 0;
+            hasTuning = true;
+            applyTuning();
+            return;
+        }
+
+        tuningRampRemaining = rampLengthSamples;
+    }
+
+    // how many combs and allpasses run, fading the ones that start or stop in or out over
+    // fadeSamples at the host rate. the comb sum is made up so fewer combs don't sound quieter.
+    // stages that come back in start from silence, nothing is allocated
+    void setStages(int newNumCombs, int newNumAllPasses, int fadeSamples)
+    {
+        const auto combs = static_cast<size_t>(juce::jlimit(1, static_cast<int>(combFilters.size()), newNumCombs));
+        const auto allPasses = static_cast<size_t>(juce::jlimit(0, static_cast<int>(allPassFilters.size()), newNumAllPasses));
+
+        // the fade runs a frame of the network at a time
+        fadeSamples = static_cast<int>(fadeSamples * networkRate / sampleRate);
+
+        if (combs == activeCombs && allPasses == activeAllPasses)
+            return;
+
+        activeCombs = combs;
+        activeAllPasses = allPasses;
+        combSumGainTarget = static_cast<SampleType>(std::sqrt(static_cast<double>(combFilters.size()) / static_cast<double>(combs)));
+
+        if (fadeSamples <= 0)
+        {
+            finishStageFade();
+            return;
+        }
+
+        const auto fade = static_cast<SampleType>(fadeSamples);
+
         for (size_t i = 0; i < combFilters.size(); ++i)
-            combFilters[i].setSize(sizeParameter, combDelaysMs[i]);
+        {
+            if (i >= numRunningCombs)
+                combFilters[i].reset();
+
+            combWeightSteps[i] = ((i < combs ? SampleType(1) : SampleType(0)) - combWeights[i]) / fade;
+        }
+
+        for (size_t i = 0; i < allPassFilters.size(); ++i)
+        {
+            if (i >= numRunningAllPasses)
+                allPassFilters[i].reset();
+
+            allPassWeightSteps[i] = ((i < allPasses ? SampleType(1) : SampleType(0)) - allPassWeights[i]) / fade;
+        }
+
+        combSumGainStep = (combSumGainTarget - combSumGain) / fade;
+        numRunningCombs = juce::jmax(numRunningCombs, combs);
+        numRunningAllPasses = juce::jmax(numRunningAllPasses, allPasses);
+        stageFadeRemaining = fadeSamples;
+    }
+
+    // delays the reflections and the late input together, clamped to maxPreDelayMs. a change
+    // glides in over the next block, see EarlyReflectionsT::setPreDelay
+    void setPreDelay(float newPreDelaySamples)
+    {
+        earlyReflections.setPreDelay(newPreDelaySamples);
     }
 
     void setWidth(float newWidth)
@@ -167,25 +466,252 @@ public:
 
     void reset()
     {
+        widthDelayLine.reset();
+
         for (auto& comb : combFilters)
             comb.reset();
         for (auto& ap : allPassFilters)
             ap.reset();
+        earlyReflections.reset();
+
+        for (auto& cascade : downCascades)
+            cascade.reset();
+        for (auto& cascade : upCascades)
+            cascade.reset();
+        for (auto& queue : wetQueues)
+            queue.fill(SampleType(0));
+        wetQueueIndex = 0;
+    }
+
+    // the late network's rate is the host rate halved until it's no more than 48k (with a
+    // little slack), the tail has nothing up there worth the cost. 1 with limitNetworkRate off
+    static int getDecimationFactor(double sampleRate, bool limitNetworkRate)
+    {
+        int factor = 1;
+
+        while (limitNetworkRate && sampleRate / factor > 50000.0 && factor < HalfBandCascadeT<SampleType>::maxFactor)
+            factor *= 2;
+
+        return factor;
     }
 
 private:
-   
+    static constexpr int maxNetworkFrames = 128;
+    static constexpr int maxNetworkSamples = 2 * maxNetworkFrames;
+
+    static void interleave(SampleType* dest, const SampleType* left, const SampleType* right, int numFrames)
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            dest[2 * i] = left[i];
+            dest[2 * i + 1] = right[i];
+        }
+    }
+
+    // the late network at its own rate. the block's four streams go down through the half-band
+    // cascades, the network runs over the frames that completed, and its output comes back up.
+    // each host sample's output is from the last full frame, so the network lags by the
+    // decimation factor plus the filters' group delay, well under a millisecond
+    void processDecimated(SampleType* lateLeft, SampleType* lateRight, const SampleType* earlyLeft, const SampleType* earlyRight,
+        int numSamples, float decay, float mix)
+    {
+        const int factor = downCascades[0].getFactor();
+
+        for (int start = 0; start < numSamples;)
+        {
+            const int count = juce::jmin(numSamples - start, maxNetworkFrames * factor);
+            int numFrames = 0;
+
+            for (int i = start; i < start + count; ++i)
+            {
+                std::array<SampleType, 4> low{};
+                const bool frameDone = downCascades[0].pushDown(lateLeft[i], low[0]);
+                downCascades[1].pushDown(lateRight[i], low[1]);
+                downCascades[2].pushDown(earlyLeft[i], low[2]);
+                downCascades[3].pushDown(earlyRight[i], low[3]);
+
+                if (frameDone)
+                {
+                    const auto frame = static_cast<size_t>(numFrames++);
+                    frameEnds[frame] = i;
+                    networkLate[2 * frame] = low[0];
+                    networkLate[2 * frame + 1] = low[1];
+                    networkEarly[2 * frame] = low[2];
+                    networkEarly[2 * frame + 1] = low[3];
+                }
+            }
+
+            if (numFrames > 0)
+                processLateBlock(networkLate.data(), networkEarly.data(), networkWet.data(), 2 * numFrames, decay, mix);
+
+            for (int i = start, frame = 0; i < start + count; ++i)
+            {
+                lateLeft[i] = wetQueues[0][static_cast<size_t>(wetQueueIndex)];
+                lateRight[i] = wetQueues[1][static_cast<size_t>(wetQueueIndex)];
+                ++wetQueueIndex;
+
+                if (frame < numFrames && frameEnds[static_cast<size_t>(frame)] == i)
+                {
+                    upCascades[0].pushUp(networkWet[static_cast<size_t>(2 * frame)], wetQueues[0].data());
+                    upCascades[1].pushUp(networkWet[static_cast<size_t>(2 * frame + 1)], wetQueues[1].data());
+                    wetQueueIndex = 0;
+                    ++frame;
+                }
+            }
+
+            start += count;
+        }
+    }
+
+    // a stage's weight for sample n of the network stream, ramping over the frames left in a
+    // stage fade and holding after. just the weight outside a fade, the steps are 0 then
+    SampleType getStageWeight(SampleType weight, SampleType step, int n) const
+    {
+        return weight + static_cast<SampleType>(juce::jmin(n / 2 + 1, stageFadeRemaining)) * step;
+    }
+
+    void advanceStageFade(int numFrames)
+    {
+        const auto frames = static_cast<SampleType>(juce::jmin(numFrames, stageFadeRemaining));
+
+        for (size_t i = 0; i < numRunningCombs; ++i)
+            combWeights[i] += frames * combWeightSteps[i];
+
+        for (size_t i = 0; i < numRunningAllPasses; ++i)
+            allPassWeights[i] += frames * allPassWeightSteps[i];
+
+        combSumGain += frames * combSumGainStep;
+        stageFadeRemaining = juce::jmax(0, stageFadeRemaining - numFrames);
+
+        if (stageFadeRemaining == 0)
+            finishStageFade();
+    }
+
+    // lands exactly on the targets and stops running the stages that faded out
+    void finishStageFade()
+    {
+        for (size_t i = 0; i < combWeights.size(); ++i)
+            combWeights[i] = i < activeCombs ? SampleType(1) : SampleType(0);
+
+        for (size_t i = 0; i < allPassWeights.size(); ++i)
+            allPassWeights[i] = i < activeAllPasses ? SampleType(1) : SampleType(0);
+
+        combWeightSteps.fill(SampleType(0));
+        allPassWeightSteps.fill(SampleType(0));
+        combSumGain = combSumGainTarget;
+        combSumGainStep = SampleType(0);
+        numRunningCombs = activeCombs;
+        numRunningAllPasses = activeAllPasses;
+        stageFadeRemaining = 0;
+    }
+
+    void advanceTuning(int numSamples)
+    {
+        if (tuningRampRemaining <= 0)
+            return;
+
+        const float t = juce::jmin(1.0f, static_cast<float>(numSamples) / static_cast<float>(tuningRampRemaining));
+
+        for (size_t i = 0; i < numCombs; ++i)
+            currentTuning.combDecayDelays[i] += (targetTuning.combDecayDelays[i] - currentTuning.combDecayDelays[i]) * t;
+
+        for (size_t channel = 0; channel < currentTuning.earlyTaps.size(); ++channel)
+        {
+            auto& current = currentTuning.earlyTaps[channel];
+            const auto& target = targetTuning.earlyTaps[channel];
+
+            for (size_t tap = 0; tap < current.delays.size(); ++tap)
+            {
+                current.delays[tap] += (target.delays[tap] - current.delays[tap]) * t;
+                current.gains[tap] += (target.gains[tap] - current.gains[tap]) * t;
+            }
+        }
+
+        currentTuning.inputGain += (targetTuning.inputGain - currentTuning.inputGain) * t;
+
+        // glides the band decays rather than the coefficients, redesigning is cheap enough
+        // to do once a block while the ramp lasts
+        auto& bands = currentTuning.bands;
+        bands.low += (targetTuning.bands.low - bands.low) * t;
+        bands.mid += (targetTuning.bands.mid - bands.mid) * t;
+        bands.high += (targetTuning.bands.high - bands.high) * t;
+        currentTuning.absorption = CombAbsorption::design(getCombLoopGain(), bands.low, bands.mid, bands.high, networkRate);
+        tuningRampRemaining = juce::jmax(0, tuningRampRemaining - numSamples);
+
+        if (tuningRampRemaining == 0)
+            currentTuning = targetTuning;
+
+        applyTuning();
+    }
+
+    void applyTuning()
+    {
+        for (size_t i = 0; i < combFilters.size(); ++i)
+        {
+            combFilters[i].setDelay(currentTuning.combDecayDelays[i]);
+            combFilters[i].setAbsorption(currentTuning.absorption);
+        }
+
+        for (size_t channel = 0; channel < currentTuning.earlyTaps.size(); ++channel)
+            earlyReflections.setTaps(static_cast<int>(channel), currentTuning.earlyTaps[channel]);
+    }
+
+    // broadband gain per trip round a comb, before the absorption
+    static double getCombLoopGain()
+    {
+        return static_cast<double>(combFeedback) * CombFilterT<SampleType>::feedbackScale * CombFilterT<SampleType>::dampingGain;
+    }
 
     double sampleRate = 44100.0;
-    const std::array<float, 8> combDelaysMs = { 15.0f, 17.0f, 19.0f, 21.0f, 25.0f, 26.6f, 28.9f, 30.8f };
-    const std::array<float, 2> allPassDelaysMs = { 11.6f, 9.2f };
-    std::array<CombFilter, 8> combFilters;
-    std::array<AllPassFilter, 2> allPassFilters;
+    double networkRate = 44100.0;
+
+    // down: late left, late right, early left, early right. up: left, right. the queues hold
+    // the last group of host rate output while the next one is gathered
+    std::array<HalfBandCascadeT<SampleType>, 4> downCascades;
+    std::array<HalfBandCascadeT<SampleType>, 2> upCascades;
+    std::array<std::array<SampleType, HalfBandCascadeT<SampleType>::maxFactor>, 2> wetQueues{};
+    int wetQueueIndex = 0;
+
+    // the network's stream a chunk at a time, see processLateBlock. frameEnds is the host
+    // sample each decimated frame completed on
+    std::array<SampleType, maxNetworkSamples> networkLate{}, networkEarly{}, networkWet{}, stageOutput{};
+    std::array<int, maxNetworkFrames> frameEnds{};
+
+    // the output stage's decorrelation, see processBlock
+    static constexpr float maxWidthDelayMs = 20.0f;
+    static constexpr float widthDecorrelation = 0.5f;
+    RingDelayT<SampleType> widthDelayLine;
+    std::array<SampleType, maxNetworkFrames> delayedMid{};
+
+    static constexpr float combFeedback = 0.3f;
+    static constexpr float allPassGain = 0.6f;
+    std::array<CombFilterT<SampleType>, numCombs> combFilters;
+    std::array<AllPassFilterT<SampleType>, numAllPasses> allPassFilters;
+
+    // see setStages, the first two allpasses run unless told otherwise
+    static constexpr size_t defaultAllPasses = numAllPasses < 2 ? numAllPasses : 2;
+    size_t activeCombs = numCombs, activeAllPasses = defaultAllPasses;
+    size_t numRunningCombs = numCombs, numRunningAllPasses = defaultAllPasses;
+    std::array<SampleType, numCombs> combWeights{}, combWeightSteps{};
+    std::array<SampleType, numAllPasses> allPassWeights{}, allPassWeightSteps{};
+    SampleType combSumGain = SampleType(1), combSumGainTarget = SampleType(1), combSumGainStep = SampleType(0);
+    int stageFadeRemaining = 0;
+    EarlyReflectionsT<SampleType> earlyReflections;
+    juce::AudioBuffer<SampleType> earlyBuffer;      // reflections for the current block, per channel
+    juce::AudioBuffer<SampleType> lateBuffer;       // pre-delayed input for the current block
     float sizeParameter = 1.0f;
     float widthParameter = 1.0f;
+
+    Tuning currentTuning;
+    Tuning targetTuning;
+    int tuningRampRemaining = 0;
+    bool hasTuning = false;
     juce::dsp::FFT fft;
     FrequencyAnalyzer* frequencyAnalyzer = nullptr;
     std::vector<float> instanceDecayBuffer; 
+    std::vector<SampleType> monoBuffer;
     
     bool demoTestSignal = false;
-};
\ No newline at end of file
+};
+
+using CustomReverb = CustomReverbT<float>;
\ No newline at end of file
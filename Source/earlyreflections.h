@@ -0,0 +1,217 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "ringdelay.h"
+
+// tap table for one channel of the early reflections, delays in samples relative to the
+// direct sound. worked out from room geometry by forRoom, normally as part of the reverb tuning
+struct EarlyReflectionTaps
+{
+    static constexpr int numTaps = 12;
+    static constexpr float maxDelayMs = 300.0f;
+
+    std::array<float, numTaps> delays{};
+    std::array<float, numTaps> gains{};
+
+    // first and second order image sources of a shoebox room, 4 per axis. size 0..1 scales the
+    // room from half to twice the base dimensions; the two channels listen from points
+    // 60 cm apart so they decorrelate. gains are normalised to sum to 1
+    static EarlyReflectionTaps forRoom(float size, double sampleRate, int channel)
+    {
+        constexpr float speedOfSound = 343.0f;
+        constexpr float wallReflectivity = 0.8f;
+        constexpr std::array<float, 3> baseRoom{ 12.0f, 18.0f, 7.0f };
+
+        const float scale = juce::jmap(juce::jlimit(0.0f, 1.0f, size), 0.5f, 2.0f);
+        const std::array<float, 3> room{ baseRoom[0] * scale, baseRoom[1] * scale, baseRoom[2] * scale };
+        const std::array<float, 3> source{ room[0] * 0.4f, room[1] * 0.25f, room[2] * 0.45f };
+        const std::array<float, 3> listener{ room[0] * 0.55f + (channel == 0 ? -0.3f : 0.3f), room[1] * 0.7f, room[2] * 0.4f };
+
+        const auto distanceTo = [&listener](const std::array<float, 3>& point)
+        {
+            const float dx = point[0] - listener[0], dy = point[1] - listener[1], dz = point[2] - listener[2];
+            return std::sqrt(dx * dx + dy * dy + dz * dz);
+        };
+
+        const float direct = distanceTo(source);
+        const float maxDelaySamples = static_cast<float>(maxDelayMs * sampleRate / 1000.0);
+
+        EarlyReflectionTaps taps;
+        float gainSum = 0.0f;
+        int tap = 0;
+
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            const float d = room[axis], s = source[axis];
+
+            // near wall, far wall, then the two double bounces
+            const std::array<float, 4> imagePositions{ -s, 2.0f * d - s, s - 2.0f * d, s + 2.0f * d };
+            const std::array<int, 4> orders{ 1, 1, 2, 2 };
+
+            for (size_t i = 0; i < imagePositions.size(); ++i, ++tap)
+            {
+                auto image = source;
+                image[axis] = imagePositions[i];
+
+                const float distance = distanceTo(image);
+                const float delaySamples = (distance - direct) / speedOfSound * static_cast<float>(sampleRate);
+                const float gain = direct / distance * std::pow(wallReflectivity, static_cast<float>(orders[i]));
+
+                taps.delays[static_cast<size_t>(tap)] = juce::jlimit(1.0f, maxDelaySamples, delaySamples);
+                taps.gains[static_cast<size_t>(tap)] = gain;
+                gainSum += gain;
+            }
+        }
+
+        for (auto& gain : taps.gains)
+            gain /= gainSum;
+
+        return taps;
+    }
+
+    float getLongestDelay() const
+    {
+        return *std::max_element(delays.begin(), delays.end());
+    }
+};
+
+// the reverb's input history, one RingDelayT per channel that everything downstream taps:
+// the pre-delay, the reflections behind it and the late network's input. the reflections are
+// evaluated a block at a time as a sparse FIR, each tap adds a contiguous, scaled span of the
+// line to the output, so the inner loops are FloatVectorOperations calls instead of a
+// per-sample gather
+template <typename SampleType>
+class EarlyReflectionsT
+{
+public:
+    static constexpr float maxPreDelayMs = 500.0f;
+
+    void prepare(double sampleRate, int numChannels, int maxBlockSize)
+    {
+        // one more for the sample past the longest fractional read
+        const int maxDelaySamples = static_cast<int>(std::ceil((maxPreDelayMs + EarlyReflectionTaps::maxDelayMs) * sampleRate / 1000.0)) + 1;
+        maxChunkSize = juce::jmax(1, maxBlockSize);
+
+        lines.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+        for (auto& line : lines)
+            line.prepare(maxDelaySamples, maxChunkSize);
+
+        taps.assign(lines.size(), EarlyReflectionTaps{});
+        maxPreDelaySamples = static_cast<float>(static_cast<int>(maxPreDelayMs * sampleRate / 1000.0));
+        preDelayStart = preDelayEnd = lastPreDelayTarget = 0.0f;
+        hasPreDelay = false;
+    }
+
+    // moves the late input and every reflection back by the same amount, in samples, by the
+    // end of the next block. the block in between glides there a sample at a time. once it
+    // stops moving it settles on the nearest whole sample, so a steady pre-delay is read
+    // straight out of the line. the first one after prepare applies straight away
+    void setPreDelay(float newPreDelaySamples)
+    {
+        const float target = juce::jlimit(0.0f, maxPreDelaySamples, newPreDelaySamples);
+
+        preDelayStart = hasPreDelay ? preDelayEnd : std::round(target);
+        preDelayEnd = !hasPreDelay || target == lastPreDelayTarget ? std::round(target) : target;
+        lastPreDelayTarget = target;
+        hasPreDelay = true;
+    }
+
+    void setTaps(int channel, const EarlyReflectionTaps& newTaps)
+    {
+        if (juce::isPositiveAndBelow(channel, static_cast<int>(taps.size())))
+            taps[static_cast<size_t>(channel)] = newTaps;
+    }
+
+    void reset()
+    {
+        for (auto& line : lines)
+            line.reset();
+    }
+
+    // pushes a block of input into the channel's line, then writes the reflections for it to
+    // earlyOutput and the pre-delayed input to lateOutput. blocks longer than prepare was told
+    // go through in pieces the line has room for
+    void process(int channel, const SampleType* input, SampleType* earlyOutput, SampleType* lateOutput, int numSamples)
+    {
+        if (!juce::isPositiveAndBelow(channel, static_cast<int>(lines.size())))
+            return;
+
+        for (int start = 0; start < numSamples; start += maxChunkSize)
+        {
+            const int count = juce::jmin(maxChunkSize, numSamples - start);
+
+            if (preDelayStart == preDelayEnd)
+                processSteady(channel, input + start, earlyOutput + start, lateOutput + start, count);
+            else
+                processGliding(channel, input + start, earlyOutput + start, lateOutput + start, start, count, numSamples);
+        }
+    }
+
+private:
+    void processSteady(int channel, const SampleType* input, SampleType* earlyOutput, SampleType* lateOutput, int numSamples)
+    {
+        auto& line = lines[static_cast<size_t>(channel)];
+        const auto& channelTaps = taps[static_cast<size_t>(channel)];
+        const int preDelaySamples = juce::roundToInt(preDelayEnd);
+
+        // the block goes in first, so a tap of d samples reads exactly d samples back, which is
+        // d plus the block behind the next write
+        line.write(input, numSamples);
+
+        // with no pre-delay this is the input again, from the line rather than another copy
+        line.getReadSpan(preDelaySamples + numSamples, numSamples).copyTo(lateOutput);
+
+        juce::FloatVectorOperations::clear(earlyOutput, numSamples);
+
+        for (int t = 0; t < EarlyReflectionTaps::numTaps; ++t)
+        {
+            const int delay = preDelaySamples + static_cast<int>(channelTaps.delays[static_cast<size_t>(t)] + 0.5f);
+            const auto gain = static_cast<SampleType>(channelTaps.gains[static_cast<size_t>(t)]);
+            line.getReadSpan(delay + numSamples, numSamples).addTo(earlyOutput, gain);
+        }
+    }
+
+    // the pre-delay ramps across the whole block, offset samples of which went before this
+    // piece. every read is interpolated, the spans would jump a whole sample at a time
+    void processGliding(int channel, const SampleType* input, SampleType* earlyOutput, SampleType* lateOutput,
+        int offset, int numSamples, int blockSize)
+    {
+        auto& line = lines[static_cast<size_t>(channel)];
+        const auto& channelTaps = taps[static_cast<size_t>(channel)];
+        const auto step = (static_cast<SampleType>(preDelayEnd) - static_cast<SampleType>(preDelayStart)) / static_cast<SampleType>(blockSize);
+
+        line.write(input, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // sample i went in numSamples - i behind the next write
+            const auto delay = static_cast<SampleType>(preDelayStart) + static_cast<SampleType>(offset + i + 1) * step
+                             + static_cast<SampleType>(numSamples - i);
+
+            lateOutput[i] = line.readFractional(delay);
+
+            SampleType early = SampleType(0);
+
+            for (int t = 0; t < EarlyReflectionTaps::numTaps; ++t)
+            {
+                const auto tapDelay = static_cast<SampleType>(static_cast<int>(channelTaps.delays[static_cast<size_t>(t)] + 0.5f));
+                early += static_cast<SampleType>(channelTaps.gains[static_cast<size_t>(t)]) * line.readFractional(delay + tapDelay);
+            }
+
+            earlyOutput[i] = early;
+        }
+    }
+
+    std::vector<RingDelayT<SampleType>> lines;
+    std::vector<EarlyReflectionTaps> taps;
+    int maxChunkSize = 1;
+
+    // the pre-delay at the start and end of the block being processed, and what it was last
+    // asked for
+    float preDelayStart = 0.0f, preDelayEnd = 0.0f, lastPreDelayTarget = 0.0f;
+    float maxPreDelaySamples = 0.0f;
+    bool hasPreDelay = false;
+};
+
+using EarlyReflections = EarlyReflectionsT<float>;
@@ -0,0 +1,3 @@
+
+
+#include "halfbandfilter.h"
@@ -0,0 +1,117 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+
+// polyphase IIR half-band filters for running the late network below the host rate, a cascade
+// of 2x stages each way. each stage is two paths of first order allpasses running at the lower
+// rate, so it costs four multiplies per low rate sample. the coefficients are a 4 coefficient
+// elliptic half-band with a 0.1 fs transition: flat to 0.2 fs, about 70 dB down past 0.3 fs
+template <typename SampleType>
+class HalfBandCascadeT
+{
+public:
+    static constexpr int maxStages = 3;     // 8x
+    static constexpr int maxFactor = 1 << maxStages;
+
+    void prepare(int numStages)
+    {
+        stages = juce::jlimit(0, maxStages, numStages);
+        reset();
+    }
+
+    void reset()
+    {
+        down.fill(Stage{});
+        up.fill(Stage{});
+    }
+
+    int getFactor() const { return 1 << stages; }
+
+    // one host rate sample in. once every getFactor() samples it returns true with the
+    // network rate sample in output
+    bool pushDown(SampleType input, SampleType& output)
+    {
+        for (int s = 0; s < stages; ++s)
+        {
+            auto& stage = down[static_cast<size_t>(s)];
+
+            if (!stage.hasHeld)
+            {
+                stage.held = input;
+                stage.hasHeld = true;
+                return false;
+            }
+
+            // the later sample of the pair goes down the even path
+            stage.hasHeld = false;
+            input = SampleType(0.5) * (stage.runEven(input) + stage.runOdd(stage.held));
+        }
+
+        output = input;
+        return true;
+    }
+
+    // one network rate sample in, getFactor() host rate samples out
+    void pushUp(SampleType input, SampleType* output)
+    {
+        std::array<SampleType, maxFactor> a{}, b{};
+        auto* current = a.data();
+        auto* next = b.data();
+        current[0] = input;
+        int count = 1;
+
+        for (int s = 0; s < stages; ++s, count *= 2)
+        {
+            auto& stage = up[static_cast<size_t>(s)];
+
+            for (int i = 0; i < count; ++i)
+            {
+                next[2 * i] = stage.runEven(current[i]);
+                next[2 * i + 1] = stage.runOdd(current[i]);
+            }
+
+            std::swap(current, next);
+        }
+
+        std::copy(current, current + count, output);
+    }
+
+private:
+    static constexpr std::array<double, 4> coefficients{ 0.07986642623635751, 0.28382934487410993,
+                                                         0.5453236510711322, 0.8344118914807379 };
+
+    struct Stage
+    {
+        // even coefficients on one path, odd on the other
+        SampleType runEven(SampleType x) { return runPath(x, 0, evenState); }
+        SampleType runOdd(SampleType x) { return runPath(x, 1, oddState); }
+
+        SampleType held = SampleType(0);
+        bool hasHeld = false;
+
+    private:
+        // per allpass the last input and output
+        using PathState = std::array<SampleType, 4>;
+
+        static SampleType runPath(SampleType x, size_t first, PathState& state)
+        {
+            for (size_t i = 0; i < 2; ++i)
+            {
+                const auto coefficient = static_cast<SampleType>(coefficients[first + 2 * i]);
+                const auto y = coefficient * (x - state[2 * i + 1]) + state[2 * i];
+                state[2 * i] = x;
+                state[2 * i + 1] = y;
+                x = y;
+            }
+
+            return x;
+        }
+
+        PathState evenState{}, oddState{};
+    };
+
+    std::array<Stage, maxStages> down, up;
+    int stages = 0;
+};
+
+using HalfBandCascade = HalfBandCascadeT<float>;
@@ -0,0 +1,83 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <numeric>
+
+// the shape of the late network, fixed at compile time: how many combs and allpasses and
+// their base delays. CustomReverbT takes one of these, so the stage arrays, weights and tuning
+// are sized by the compiler; the standard shape is the only one. the loops still run over
+// however many stages the quality tier has switched on, that's a runtime count. allpasses
+// past the first two are the extra diffusion of the high and render tiers
+struct StandardTopology
+{
+    static constexpr std::array<float, 8> combDelaysMs{ 15.0f, 17.0f, 19.0f, 21.0f, 25.0f, 26.6f, 28.9f, 30.8f };
+    static constexpr std::array<float, 6> allPassDelaysMs{ 11.6f, 9.2f, 5.3f, 3.7f, 2.9f, 1.9f };
+};
+
+// delay lengths in samples with no common factor between any two, so no two loops
+// reinforce the same resonances. each length only ever moves up to the next free value
+template <size_t N>
+constexpr std::array<int, N> makeMutuallyPrime(std::array<int, N> lengths)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        lengths[i] = lengths[i] < 1 ? 1 : lengths[i];
+
+        for (bool clash = true; clash;)
+        {
+            clash = false;
+
+            for (size_t j = 0; j < i && !clash; ++j)
+                clash = std::gcd(lengths[i], lengths[j]) != 1;
+
+            if (clash)
+                ++lengths[i];
+        }
+    }
+
+    return lengths;
+}
+
+template <size_t N>
+constexpr std::array<int, N> makeDelayLengths(const std::array<float, N>& delaysMs, double sampleRate)
+{
+    std::array<int, N> lengths{};
+
+    for (size_t i = 0; i < N; ++i)
+        lengths[i] = static_cast<int>(static_cast<double>(delaysMs[i]) * sampleRate / 1000.0 + 0.5);
+
+    return makeMutuallyPrime(lengths);
+}
+
+// a topology's base lengths in samples, worked out by the compiler for the rates the network
+// usually runs at and at runtime for anything else
+template <typename Topology>
+struct TopologyDelays
+{
+    static constexpr size_t numCombs = Topology::combDelaysMs.size();
+    static constexpr size_t numAllPasses = Topology::allPassDelaysMs.size();
+
+    struct Lengths
+    {
+        std::array<int, numCombs> combs{};
+        std::array<int, numAllPasses> allPasses{};
+    };
+
+    static constexpr Lengths make(double sampleRate)
+    {
+        return { makeDelayLengths(Topology::combDelaysMs, sampleRate), makeDelayLengths(Topology::allPassDelaysMs, sampleRate) };
+    }
+
+    static constexpr std::array<double, 6> commonRates{ 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    static constexpr std::array<Lengths, 6> commonLengths{ make(44100.0), make(48000.0), make(88200.0),
+                                                           make(96000.0), make(176400.0), make(192000.0) };
+
+    static Lengths forRate(double sampleRate)
+    {
+        for (size_t i = 0; i < commonRates.size(); ++i)
+            if (commonRates[i] == sampleRate)
+                return commonLengths[i];
+
+        return make(sampleRate);
+    }
+};
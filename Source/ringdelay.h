@@ -0,0 +1,113 @@
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+// a single channel delay line with a power of two capacity, wrapped with a mask instead of a
+// modulo. a sample at a time it reads behind the write position and pushes, a block at a time
+// it hands the line out as at most two contiguous spans, so loops over it are plain array walks
+template <typename SampleType>
+class RingDelayT
+{
+public:
+    // a run of the line in time order, second is empty unless the run wraps
+    struct Span
+    {
+        SampleType* first = nullptr;
+        int firstSize = 0;
+        SampleType* second = nullptr;
+        int secondSize = 0;
+
+        void copyTo(SampleType* dest) const
+        {
+            juce::FloatVectorOperations::copy(dest, first, firstSize);
+            juce::FloatVectorOperations::copy(dest + firstSize, second, secondSize);
+        }
+
+        void addTo(SampleType* dest, SampleType gain) const
+        {
+            juce::FloatVectorOperations::addWithMultiply(dest, first, gain, firstSize);
+            juce::FloatVectorOperations::addWithMultiply(dest + firstSize, second, gain, secondSize);
+        }
+    };
+
+    // reads reach maxDelaySamples behind a block of up to maxBlockSize that's just been written
+    void prepare(int maxDelaySamples, int maxBlockSize = 1)
+    {
+        const int size = juce::nextPowerOfTwo(juce::jmax(1, maxDelaySamples) + juce::jmax(1, maxBlockSize) + 1);
+        buffer.assign(static_cast<size_t>(size), SampleType(0));
+        mask = size - 1;
+        maxDelay = juce::jmax(1, maxDelaySamples);
+        writePosition = 0;
+    }
+
+    void reset()
+    {
+        std::fill(buffer.begin(), buffer.end(), SampleType(0));
+        writePosition = 0;
+    }
+
+    int getMaximumDelay() const { return maxDelay; }
+
+    // delaySamples behind the next write, 1 is the sample pushed last
+    SampleType read(int delaySamples) const
+    {
+        return buffer[static_cast<size_t>((writePosition - delaySamples) & mask)];
+    }
+
+    // linear between the samples either side, like juce::dsp::DelayLine's default
+    SampleType readFractional(SampleType delaySamples) const
+    {
+        const int whole = static_cast<int>(delaySamples);
+        const auto fraction = delaySamples - static_cast<SampleType>(whole);
+        const auto nearer = read(whole);
+        return nearer + fraction * (read(whole + 1) - nearer);
+    }
+
+    void push(SampleType sample)
+    {
+        buffer[static_cast<size_t>(writePosition)] = sample;
+        writePosition = (writePosition + 1) & mask;
+    }
+
+    // numSamples in a row, the first delaySamples behind the next write. with delaySamples at
+    // least numSamples every one of them has been written already
+    Span getReadSpan(int delaySamples, int numSamples)
+    {
+        jassert(delaySamples <= mask);
+        return getSpan((writePosition - delaySamples) & mask, numSamples);
+    }
+
+    // where the next numSamples go, advance by as many once they're filled in
+    Span getWriteSpan(int numSamples)
+    {
+        return getSpan(writePosition, numSamples);
+    }
+
+    void advance(int numSamples)
+    {
+        writePosition = (writePosition + numSamples) & mask;
+    }
+
+    void write(const SampleType* source, int numSamples)
+    {
+        const auto span = getWriteSpan(numSamples);
+        juce::FloatVectorOperations::copy(span.first, source, span.firstSize);
+        juce::FloatVectorOperations::copy(span.second, source + span.firstSize, span.secondSize);
+        advance(numSamples);
+    }
+
+private:
+    Span getSpan(int start, int numSamples)
+    {
+        jassert(numSamples <= mask + 1);
+        const int firstSize = juce::jmin(numSamples, mask + 1 - start);
+        return { buffer.data() + start, firstSize, buffer.data(), numSamples - firstSize };
+    }
+
+    std::vector<SampleType> buffer = std::vector<SampleType>(1, SampleType(0));
+    int mask = 0;
+    int maxDelay = 0;
+    int writePosition = 0;
+};
+
+using RingDelay = RingDelayT<float>;